@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "pixel_kernels.hpp"
+#include "screen.hpp"
+
+// blend policies for the screen primitives
+// a policy combines the frame buffer pixel (dst) with the drawing colour (src); primitives are templates on
+// the policy, so the choice is resolved at compile time and the inner loops carry no per-pixel branch
+namespace screen
+{
+    struct blend_replace
+    {
+        inline pixel::px_t operator()(const pixel::px_t, const pixel::px_t src) const
+        {
+            return src;
+        }
+    };
+
+    // alpha 0 keeps dst, 255 replaces it with src
+    struct blend_alpha
+    {
+        uint32_t w_src;
+        explicit blend_alpha(const uint8_t alpha) : w_src(alpha + (alpha >> 7)) {}
+        inline pixel::px_t operator()(const pixel::px_t dst, const pixel::px_t src) const
+        {
+            return pixel::px_mix(dst, src, 256 - w_src, w_src);
+        }
+    };
+
+    // saturating add; glow and light effects
+    struct blend_add
+    {
+        inline pixel::px_t operator()(const pixel::px_t dst, const pixel::px_t src) const
+        {
+            return pixel::px_add_sat(dst, src);
+        }
+    };
+
+    // dst * src / 255; darkening, tinting
+    struct blend_multiply
+    {
+        inline pixel::px_t operator()(const pixel::px_t dst, const pixel::px_t src) const
+        {
+            return pixel::px_multiply(dst, src);
+        }
+    };
+
+    // per channel maximum; overlapping trails without saturating to white
+    struct blend_max
+    {
+        inline pixel::px_t operator()(const pixel::px_t dst, const pixel::px_t src) const
+        {
+            return pixel::px_max(dst, src);
+        }
+    };
+
+    static inline pixel::px_t blend_source(const ws2812::led_color_t c)
+    {
+        return pixel::px_load(c);
+    }
+
+    // indexed frame buffers hold palette indices, which can only be replaced
+    static inline uint8_t blend_source(const uint8_t index)
+    {
+        return index;
+    }
+
+    static inline void blend_into(uint8_t &dst, const uint8_t src, const blend_replace &)
+    {
+        dst = src;
+    }
+
+    // deep colour frame buffers are only replaced as well
+    static inline scr_deep_color_t blend_source(const scr_deep_color_t c)
+    {
+        return c;
+    }
+
+    static inline void blend_into(scr_deep_color_t &dst, const scr_deep_color_t src, const blend_replace &)
+    {
+        dst = src;
+    }
+
+    template <typename BLEND>
+    static inline void blend_into(ws2812::led_color_t &dst, const pixel::px_t src, const BLEND &blend)
+    {
+        pixel::px_store(dst, blend(pixel::px_load(dst), src));
+    }
+
+    // partial coverage (0..256) fades between dst and the fully blended result; used by anti-aliased shapes
+    template <typename BLEND>
+    static inline void blend_into(ws2812::led_color_t &dst, const pixel::px_t src, const BLEND &blend, const uint32_t coverage)
+    {
+        const pixel::px_t d = pixel::px_load(dst);
+        pixel::px_store(dst, pixel::px_mix(d, blend(d, src), 256 - coverage, coverage));
+    }
+}
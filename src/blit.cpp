@@ -0,0 +1,198 @@
+#include <hardware/dma.h>
+#include <hardware/irq.h>
+#include <hardware/sync.h>
+#include <string.h>
+
+#include "blit.hpp"
+
+namespace blit
+{
+    static_assert(sizeof(ws2812::led_color_t) == 4, "the blit engine moves one pixel per 32-bit dma transfer");
+
+    typedef struct
+    {
+        const ws2812::led_color_t *read;
+        ws2812::led_color_t *write;
+        uint32_t fill;       // source word of fills; read without increment
+        uint32_t row_length; // pixels per dma transfer
+        uint16_t rows;       // number of transfers, SCREEN_WIDTH pixels apart
+        bool is_fill;
+    } blit_command_t;
+
+    // ring of queued commands; head is the command in flight, tail the next free slot
+    // head and tail only grow, so they double as the completed and issued fences
+    static blit_command_t blit_queue[BLIT_QUEUE_SIZE];
+    static volatile uint32_t blit_queue_head = 0;
+    static volatile uint32_t blit_queue_tail = 0;
+    static volatile uint16_t blit_row = 0;
+    static volatile bool blit_busy = false;
+
+    static int blit_dma_channel = -1;
+    static dma_channel_config blit_config_copy;
+    static dma_channel_config blit_config_fill;
+
+    static inline bool __blit_clip(int &x, int &y, int &w, int &h)
+    {
+        if (x < 0)
+        {
+            w += x;
+            x = 0;
+        }
+        if (y < 0)
+        {
+            h += y;
+            y = 0;
+        }
+        if (x + w > screen::SCREEN_WIDTH)
+        {
+            w = screen::SCREEN_WIDTH - x;
+        }
+        if (y + h > screen::SCREEN_HEIGHT)
+        {
+            h = screen::SCREEN_HEIGHT - y;
+        }
+        return w > 0 && h > 0;
+    }
+
+    // called with the blit irq masked (from the irq itself or with interrupts disabled)
+    static void __blit_start_row()
+    {
+        blit_command_t *cmd = &blit_queue[blit_queue_head % BLIT_QUEUE_SIZE];
+        const uint32_t offset = blit_row * screen::SCREEN_WIDTH;
+        blit_row = blit_row + 1;
+
+        dma_channel_set_config(blit_dma_channel, cmd->is_fill ? &blit_config_fill : &blit_config_copy, false);
+        dma_channel_set_read_addr(blit_dma_channel, cmd->is_fill ? (const void *)&cmd->fill : (const void *)(cmd->read + offset), false);
+        dma_channel_set_write_addr(blit_dma_channel, cmd->write + offset, false);
+        dma_channel_set_trans_count(blit_dma_channel, cmd->row_length, true);
+    }
+
+    void __isr blit_dma_complete_handler()
+    {
+        if (!dma_channel_get_irq1_status(blit_dma_channel))
+        {
+            return;
+        }
+        dma_channel_acknowledge_irq1(blit_dma_channel);
+
+        if (blit_row < blit_queue[blit_queue_head % BLIT_QUEUE_SIZE].rows)
+        {
+            __blit_start_row();
+            return;
+        }
+
+        // command completed
+        blit_row = 0;
+        blit_queue_head = blit_queue_head + 1;
+        if (blit_queue_head != blit_queue_tail)
+        {
+            __blit_start_row();
+        }
+        else
+        {
+            blit_busy = false;
+        }
+    }
+
+    void blit_init()
+    {
+        blit_dma_channel = dma_claim_unused_channel(true);
+
+        blit_config_copy = dma_channel_get_default_config(blit_dma_channel);
+        channel_config_set_transfer_data_size(&blit_config_copy, DMA_SIZE_32);
+        channel_config_set_read_increment(&blit_config_copy, true);
+        channel_config_set_write_increment(&blit_config_copy, true);
+
+        // fills read the same source word over and over
+        blit_config_fill = blit_config_copy;
+        channel_config_set_read_increment(&blit_config_fill, false);
+
+        // DMA_IRQ_0 belongs to the ws2812 output
+        dma_channel_set_irq1_enabled(blit_dma_channel, true);
+        irq_add_shared_handler(DMA_IRQ_1, blit_dma_complete_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_1, true);
+    }
+
+    static blit_fence_t __blit_enqueue(const blit_command_t &cmd)
+    {
+        // wait for a free slot
+        while (blit_queue_tail - blit_queue_head >= BLIT_QUEUE_SIZE)
+        {
+            tight_loop_contents();
+        }
+
+        const uint32_t irq_state = save_and_disable_interrupts();
+        blit_queue[blit_queue_tail % BLIT_QUEUE_SIZE] = cmd;
+        blit_queue_tail = blit_queue_tail + 1;
+        if (!blit_busy)
+        {
+            blit_busy = true;
+            __blit_start_row();
+        }
+        restore_interrupts(irq_state);
+
+        return blit_queue_tail;
+    }
+
+    static blit_fence_t __blit_rect(frame_buffer_t *dst, const frame_buffer_t *src, const uint32_t fill, int x, int y, int w, int h)
+    {
+        if (!__blit_clip(x, y, w, h))
+        {
+            return blit_queue_tail;
+        }
+
+        blit_command_t cmd;
+        cmd.read = src ? &(*src)[y][x] : nullptr;
+        cmd.write = &(*dst)[y][x];
+        cmd.fill = fill;
+        cmd.is_fill = src == nullptr;
+        if (w == screen::SCREEN_WIDTH)
+        {
+            // full-width rows are contiguous; move them in one transfer
+            cmd.row_length = w * h;
+            cmd.rows = 1;
+        }
+        else
+        {
+            cmd.row_length = w;
+            cmd.rows = h;
+        }
+
+        return __blit_enqueue(cmd);
+    }
+
+    blit_fence_t blit_clear(frame_buffer_t *dst)
+    {
+        return __blit_rect(dst, nullptr, 0, 0, 0, screen::SCREEN_WIDTH, screen::SCREEN_HEIGHT);
+    }
+
+    blit_fence_t blit_fill(frame_buffer_t *dst, int x, int y, int w, int h, const ws2812::led_color_t c)
+    {
+        uint32_t fill;
+        memcpy(&fill, &c, sizeof(fill));
+        return __blit_rect(dst, nullptr, fill, x, y, w, h);
+    }
+
+    blit_fence_t blit_copy(frame_buffer_t *dst, const frame_buffer_t *src, int x, int y, int w, int h)
+    {
+        return __blit_rect(dst, src, 0, x, y, w, h);
+    }
+
+    bool blit_fence_reached(const blit_fence_t fence)
+    {
+        return (int32_t)(blit_queue_head - fence) >= 0;
+    }
+
+    void blit_wait(const blit_fence_t fence)
+    {
+        while (!blit_fence_reached(fence))
+        {
+            tight_loop_contents();
+        }
+    }
+
+    void blit_wait_all()
+    {
+        blit_wait(blit_queue_tail);
+    }
+}
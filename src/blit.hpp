@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#include "screen.hpp"
+
+// dma blit engine for bulk pixel moves: clears, solid fills and rectangular copies between frame buffers
+// commands are queued and executed in the background by a spare dma channel, one row per transfer
+// (contiguous full-width regions in a single transfer), sequenced from the dma completion irq
+namespace blit
+{
+    typedef screen::scr_frame_buffer_t frame_buffer_t;
+
+    // fences increase monotonically; a fence is reached when its command and all commands before it completed
+    typedef uint32_t blit_fence_t;
+
+    const auto BLIT_QUEUE_SIZE = 16;
+
+    void blit_init();
+
+    // rectangles are clipped to the screen; fully clipped commands return an already reached fence
+    blit_fence_t blit_clear(frame_buffer_t *dst);
+    blit_fence_t blit_fill(frame_buffer_t *dst, int x, int y, int w, int h, const ws2812::led_color_t c);
+    blit_fence_t blit_copy(frame_buffer_t *dst, const frame_buffer_t *src, int x, int y, int w, int h);
+
+    bool blit_fence_reached(const blit_fence_t fence);
+    void blit_wait(const blit_fence_t fence);
+    void blit_wait_all();
+}
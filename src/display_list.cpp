@@ -0,0 +1,143 @@
+#include <string.h>
+
+#include "display_list.hpp"
+
+namespace screen
+{
+    static scr_display_list_t __scr_display_lists[2];
+    scr_display_list_t *scr_display_list = &__scr_display_lists[0];
+
+    static inline dl_command_t *__dl_append(const uint8_t op, const ws2812::led_color_t c)
+    {
+        if (scr_display_list->count >= DL_MAX_COMMANDS)
+        {
+            scr_display_list->overflow = true;
+            return nullptr;
+        }
+        dl_command_t *cmd = &scr_display_list->commands[scr_display_list->count++];
+        cmd->op = op;
+        cmd->c = c;
+        return cmd;
+    }
+
+    bool dl_rect(const int x, const int y, const int w, const int h, const ws2812::led_color_t c)
+    {
+        dl_command_t *cmd = __dl_append(DL_RECT, c);
+        if (cmd)
+        {
+            cmd->rect = {(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h, nullptr};
+        }
+        return cmd;
+    }
+
+    bool dl_line(const int x0, const int y0, const int x1, const int y1, const ws2812::led_color_t c)
+    {
+        dl_command_t *cmd = __dl_append(DL_LINE, c);
+        if (cmd)
+        {
+            cmd->line = {(int16_t)x0, (int16_t)y0, (int16_t)x1, (int16_t)y1};
+        }
+        return cmd;
+    }
+
+    bool dl_orb(const float x, const float y, const float radius, const ws2812::led_color_t c)
+    {
+        dl_command_t *cmd = __dl_append(DL_ORB, c);
+        if (cmd)
+        {
+            cmd->orb = {x, y, radius};
+        }
+        return cmd;
+    }
+
+    bool dl_text(const char *str, const int x, const int y, const ws2812::led_color_t c, const font_3x5_alignment_t alignment)
+    {
+        // the string is copied; the caller's buffer may change before core1 gets to it
+        const auto len = strlen(str) + 1;
+        if (scr_display_list->text_used + len > DL_TEXT_POOL_SIZE)
+        {
+            scr_display_list->overflow = true;
+            return false;
+        }
+        dl_command_t *cmd = __dl_append(DL_TEXT, c);
+        if (cmd)
+        {
+            cmd->alignment = alignment;
+            cmd->text_offset = scr_display_list->text_used;
+            cmd->text = {(int16_t)x, (int16_t)y, 0};
+            memcpy(&scr_display_list->text[cmd->text_offset], str, len);
+            scr_display_list->text_used += len;
+        }
+        return cmd;
+    }
+
+    bool dl_number(const uint number, const int x, const int y, const ws2812::led_color_t c, const font_3x5_alignment_t alignment)
+    {
+        dl_command_t *cmd = __dl_append(DL_NUMBER, c);
+        if (cmd)
+        {
+            cmd->alignment = alignment;
+            cmd->text = {(int16_t)x, (int16_t)y, number};
+        }
+        return cmd;
+    }
+
+    bool dl_blit(const scr_frame_buffer_t *src, const int x, const int y, const int w, const int h)
+    {
+        dl_command_t *cmd = __dl_append(DL_BLIT, ws2812_pack_color(0, 0, 0));
+        if (cmd)
+        {
+            cmd->rect = {(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h, src};
+        }
+        return cmd;
+    }
+
+    scr_display_list_t *dl_swap()
+    {
+        scr_display_list_t *recorded = scr_display_list;
+        scr_display_list = (recorded == &__scr_display_lists[0]) ? &__scr_display_lists[1] : &__scr_display_lists[0];
+        scr_display_list->count = 0;
+        scr_display_list->text_used = 0;
+        scr_display_list->overflow = false;
+        return recorded;
+    }
+
+    static void __dl_blit(scr_frame_buffer_t &fb, const scr_frame_buffer_t &src, int x, int y, int w, int h)
+    {
+        FIX_RECT_COORDS(x, y, w, h, SCREEN_WIDTH, SCREEN_HEIGHT)
+
+        for (int i = y; i < y + h; i++)
+        {
+            memcpy(&fb[i][x], &src[i][x], w * sizeof(ws2812::led_color_t));
+        }
+    }
+
+    void dl_rasterise(const scr_display_list_t *dl, scr_frame_buffer_t &fb)
+    {
+        for (int i = 0; i < dl->count; i++)
+        {
+            const dl_command_t &cmd = dl->commands[i];
+            switch (cmd.op)
+            {
+            case DL_RECT:
+                draw_rect(fb, cmd.rect.x, cmd.rect.y, cmd.rect.w, cmd.rect.h, cmd.c);
+                break;
+            case DL_LINE:
+                draw_line(fb, cmd.line.x0, cmd.line.y0, cmd.line.x1, cmd.line.y1, cmd.c);
+                break;
+            case DL_ORB:
+                draw_orb(fb, cmd.orb.x, cmd.orb.y, cmd.orb.radius, cmd.c);
+                break;
+            case DL_TEXT:
+                draw_3x5_string(fb, &dl->text[cmd.text_offset], cmd.text.x, cmd.text.y, cmd.c, (font_3x5_alignment_t)cmd.alignment);
+                break;
+            case DL_NUMBER:
+                draw_3x5_number(fb, cmd.text.value, cmd.text.x, cmd.text.y, cmd.c, (font_3x5_alignment_t)cmd.alignment);
+                break;
+            case DL_BLIT:
+                __dl_blit(fb, *cmd.rect.src, cmd.rect.x, cmd.rect.y, cmd.rect.w, cmd.rect.h);
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "screen.hpp"
+#include "screen_primitives.hpp"
+
+namespace screen
+{
+    // display list: compact drawing commands recorded by core0 during game_draw() and rasterised by
+    // core1 into the frame buffer right before gamma correction and dithering
+    // commands are drawn on top of whatever core0 drew into scr_screen directly
+    enum dl_op_t : uint8_t
+    {
+        DL_RECT = 0,
+        DL_LINE,
+        DL_ORB,
+        DL_TEXT,
+        DL_NUMBER,
+        DL_BLIT,
+    };
+
+    typedef struct
+    {
+        uint8_t op;
+        uint8_t alignment;    // DL_TEXT and DL_NUMBER
+        uint16_t text_offset; // DL_TEXT; offset of the string in the text pool
+        ws2812::led_color_t c;
+        union
+        {
+            struct
+            {
+                int16_t x, y, w, h;
+                const scr_frame_buffer_t *src; // DL_BLIT only; copied to the same rectangle
+            } rect;
+            struct
+            {
+                int16_t x0, y0, x1, y1;
+            } line;
+            struct
+            {
+                float x, y, radius;
+            } orb;
+            struct
+            {
+                int16_t x, y;
+                uint32_t value; // DL_NUMBER only
+            } text;
+        };
+    } dl_command_t;
+
+    const auto DL_MAX_COMMANDS = 128;
+    const auto DL_TEXT_POOL_SIZE = 256;
+
+    typedef struct
+    {
+        dl_command_t commands[DL_MAX_COMMANDS];
+        char text[DL_TEXT_POOL_SIZE];
+        uint16_t count;
+        uint16_t text_used;
+        bool overflow; // commands were dropped
+    } scr_display_list_t;
+
+    // the list core0 is currently recording into; swapped together with scr_screen
+    extern scr_display_list_t *scr_display_list;
+
+    // recording; each returns false (and drops the command) when the list is full
+    bool dl_rect(const int x, const int y, const int w, const int h, const ws2812::led_color_t c);
+    bool dl_line(const int x0, const int y0, const int x1, const int y1, const ws2812::led_color_t c);
+    bool dl_orb(const float x, const float y, const float radius, const ws2812::led_color_t c);
+    bool dl_text(const char *str, const int x, const int y, const ws2812::led_color_t c, const font_3x5_alignment_t alignment = FONT_3X5_LEFT);
+    bool dl_number(const uint number, const int x, const int y, const ws2812::led_color_t c, const font_3x5_alignment_t alignment = FONT_3X5_LEFT);
+    bool dl_blit(const scr_frame_buffer_t *src, const int x, const int y, const int w, const int h);
+
+    // hand the recorded list over for rasterisation and start recording into an empty one
+    scr_display_list_t *dl_swap();
+    void dl_rasterise(const scr_display_list_t *dl, scr_frame_buffer_t &fb);
+}
@@ -3,14 +3,14 @@
 #include <cstdint>
 
 #pragma pack(push, 1)
-static const uint8_t font_3x5_missing_char[5] = {
+static constexpr uint8_t font_3x5_missing_char[5] = {
     0b101101,
     0b010010,
     0b101101,
     0b010010,
     0b101101};
 
-static const uint8_t font_3x5_32_96_optimized[33][5] = {
+static constexpr uint8_t font_3x5_32_96_optimized[33][5] = {
     {0b000010, // space + !
      0b000010,
      0b000010,
@@ -208,7 +208,7 @@ static const uint8_t font_3x5_32_96_optimized[33][5] = {
      0b000000,
      0b000000,
      0b000000}};
-static const uint8_t font_3x5_122_126_optimized[3][5] = {
+static constexpr uint8_t font_3x5_122_126_optimized[3][5] = {
     {0b000011, // padding + {
      0b000010,
      0b000110,
@@ -0,0 +1,71 @@
+#include "hud.hpp"
+#include "display_list.hpp"
+#include "rotary_encoder.hpp"
+#include "screen.hpp"
+
+namespace hud
+{
+    bool hud_enabled = false;
+
+    static hud_switch_t __switch;
+
+    // frames drawn in the last full second
+    static int __frames = 0;
+    static int __frame_rate = 0;
+    static absolute_time_t __second_start;
+
+    // top left corner: the frame rate, then one bar per stage, on a black panel
+    static const int HUD_X = 0;
+    static const int HUD_Y = 0;
+    static const int HUD_BARS_Y = HUD_Y + 7;
+
+    void hud_draw()
+    {
+        const absolute_time_t now = get_absolute_time();
+        const bool pressed = rotary_encoder::rotary_encoder_fetch_sw_state(&rotary_encoder::rotary_encoders[HUD_ENCODER]) == rotary_encoder::ROTARY_ENCODER_SW_PRESSED;
+        if (hud_switch_update(__switch, pressed, now))
+        {
+            hud_enabled = !hud_enabled;
+        }
+
+        __frames++;
+        if (absolute_time_diff_us(__second_start, now) >= 1000000)
+        {
+            __frame_rate = __frames;
+            __frames = 0;
+            __second_start = now;
+        }
+
+        if (!hud_enabled)
+        {
+            return;
+        }
+
+        // a handful of display list commands; core1 rasterises them after the rest of the frame
+        const int64_t refresh_us = screen::scr_last_present().refresh_us;
+        const int64_t full_scale_us = refresh_us > 0 ? refresh_us : HUD_DEFAULT_REFRESH_US;
+        const struct
+        {
+            int64_t time_us;
+            ws2812::led_color_t color;
+        } bars[] = {
+            {screen::scr_profile.time_gamma_correction, ws2812_pack_color(48, 0, 0)},
+            {screen::scr_profile.time_dithering, ws2812_pack_color(48, 24, 0)},
+            {screen::scr_profile.time_screen_to_led_colors, ws2812_pack_color(0, 48, 0)},
+            {screen::scr_profile.time_led_colors_to_bitplanes, ws2812_pack_color(0, 24, 48)},
+            {screen::scr_profile.time_wait_for_DMA, ws2812_pack_color(32, 0, 48)},
+        };
+        const int bar_count = sizeof(bars) / sizeof(bars[0]);
+
+        screen::dl_rect(HUD_X, HUD_Y, HUD_BAR_WIDTH + 2, HUD_BARS_Y - HUD_Y + bar_count + 1, ws2812_pack_color(0, 0, 0));
+        screen::dl_number(__frame_rate, HUD_X + 1, HUD_Y + 1, ws2812_pack_color(32, 32, 32));
+        for (int i = 0; i < bar_count; i++)
+        {
+            const int length = hud_bar_length(bars[i].time_us, full_scale_us);
+            if (length)
+            {
+                screen::dl_rect(HUD_X + 1, HUD_BARS_Y + i, length, 1, bars[i].color);
+            }
+        }
+    }
+}
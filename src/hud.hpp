@@ -0,0 +1,63 @@
+#pragma once
+
+#include <pico/time.h>
+#include <stdint.h>
+
+// on-display performance hud: frame rate and one bar per output stage in a corner of the screen, on top of
+// everything else; toggled by holding the switch of an encoder
+#ifndef HUD_ENCODER // whose switch toggles the hud
+#define HUD_ENCODER 0
+#endif
+#ifndef HUD_LONG_PRESS_US
+#define HUD_LONG_PRESS_US 800000
+#endif
+
+namespace hud
+{
+    const auto HUD_BAR_WIDTH = 16;           // pixels of a bar that takes a whole refresh
+    const auto HUD_DEFAULT_REFRESH_US = 16667; // full scale until core1 has measured its refresh period
+
+    // long press detection; fires once per press, when the switch has been held for HUD_LONG_PRESS_US
+    typedef struct
+    {
+        bool pressed;
+        bool fired;
+        absolute_time_t since;
+    } hud_switch_t;
+
+    static inline bool hud_switch_update(hud_switch_t &sw, const bool pressed, const absolute_time_t now)
+    {
+        if (!pressed)
+        {
+            sw.pressed = sw.fired = false;
+            return false;
+        }
+        if (!sw.pressed)
+        {
+            sw.pressed = true;
+            sw.since = now;
+        }
+        if (!sw.fired && absolute_time_diff_us(sw.since, now) >= HUD_LONG_PRESS_US)
+        {
+            sw.fired = true;
+            return true;
+        }
+        return false;
+    }
+
+    // a stage time as a bar; anything that ran at all gets a pixel, and no bar leaves the panel
+    static inline int hud_bar_length(const int64_t time_us, const int64_t full_scale_us)
+    {
+        if (time_us <= 0)
+        {
+            return 0;
+        }
+        const int64_t length = (time_us * HUD_BAR_WIDTH + full_scale_us - 1) / full_scale_us;
+        return length < HUD_BAR_WIDTH ? length : HUD_BAR_WIDTH;
+    }
+
+    extern bool hud_enabled;
+
+    // at the end of a frame, right before the swap: polls the switch and records the hud into the display list
+    void hud_draw();
+}
@@ -0,0 +1,132 @@
+#include <atomic>
+#include <string.h>
+
+#include "latency.hpp"
+
+namespace latency
+{
+    // the probe moves through its states in pipeline order; each transition is made by one side only
+    // (idle -> input by the isr, input -> consumed by core0, the rest by core1), and the times of a state
+    // are written before the state is stored
+    typedef enum
+    {
+        PROBE_IDLE,
+        PROBE_INPUT,
+        PROBE_CONSUMED,
+        PROBE_PICKED,
+    } probe_state_t;
+
+    static std::atomic<int> __probe_state(PROBE_IDLE);
+    static absolute_time_t __probe_input, __probe_consume, __probe_pickup;
+    static uint32_t __probe_generation;
+
+    static uint32_t __histogram[LATENCY_BINS];
+    static uint32_t __samples = 0;
+    static int64_t __min_us, __max_us, __sum_us;
+    static int64_t __stage_sum_us[LATENCY_STAGES];
+
+    // generations wrap; a frame at or after the probed one carries its input
+    static inline bool __shows_probe(const uint32_t generation)
+    {
+        return (int32_t)(generation - __probe_generation) >= 0;
+    }
+
+    void latency_input()
+    {
+        if (__probe_state.load() == PROBE_IDLE)
+        {
+            __probe_input = get_absolute_time();
+            __probe_state.store(PROBE_INPUT);
+        }
+    }
+
+    void latency_consume(const uint32_t generation)
+    {
+        if (__probe_state.load() == PROBE_INPUT)
+        {
+            __probe_generation = generation;
+            __probe_consume = get_absolute_time();
+            __probe_state.store(PROBE_CONSUMED);
+        }
+    }
+
+    void latency_pickup(const uint32_t generation)
+    {
+        if (__probe_state.load() == PROBE_CONSUMED && __shows_probe(generation))
+        {
+            __probe_pickup = get_absolute_time();
+            __probe_state.store(PROBE_PICKED);
+        }
+    }
+
+    void latency_present(const uint32_t generation, const absolute_time_t dma_done, const absolute_time_t latched)
+    {
+        if (__probe_state.load() != PROBE_PICKED || !__shows_probe(generation))
+        {
+            return;
+        }
+
+        const int64_t total = absolute_time_diff_us(__probe_input, latched);
+        const int64_t bin = total / LATENCY_BIN_US;
+        __histogram[bin < LATENCY_BINS - 1 ? bin : LATENCY_BINS - 1]++;
+        __min_us = __samples && __min_us < total ? __min_us : total;
+        __max_us = __samples && __max_us > total ? __max_us : total;
+        __sum_us += total;
+        __stage_sum_us[LATENCY_STAGE_CONSUME] += absolute_time_diff_us(__probe_input, __probe_consume);
+        __stage_sum_us[LATENCY_STAGE_PICKUP] += absolute_time_diff_us(__probe_consume, __probe_pickup);
+        __stage_sum_us[LATENCY_STAGE_DMA] += absolute_time_diff_us(__probe_pickup, dma_done);
+        __stage_sum_us[LATENCY_STAGE_LATCH] += absolute_time_diff_us(dma_done, latched);
+        __samples++;
+
+        __probe_state.store(PROBE_IDLE);
+    }
+
+    static int64_t __percentile(const uint32_t samples, const uint32_t percent)
+    {
+        const uint32_t rank = (samples * percent + 99) / 100;
+        uint32_t seen = 0;
+        for (int bin = 0; bin < LATENCY_BINS; bin++)
+        {
+            seen += __histogram[bin];
+            if (seen >= rank)
+            {
+                return (int64_t)(bin + 1) * LATENCY_BIN_US;
+            }
+        }
+        return (int64_t)LATENCY_BINS * LATENCY_BIN_US;
+    }
+
+    latency_stats_t latency_stats()
+    {
+        latency_stats_t stats = {};
+        stats.samples = __samples;
+        if (__samples)
+        {
+            stats.min_us = __min_us;
+            stats.max_us = __max_us;
+            stats.mean_us = __sum_us / __samples;
+            stats.p50_us = __percentile(__samples, 50);
+            stats.p90_us = __percentile(__samples, 90);
+            stats.p99_us = __percentile(__samples, 99);
+            for (int stage = 0; stage < LATENCY_STAGES; stage++)
+            {
+                stats.stage_mean_us[stage] = __stage_sum_us[stage] / __samples;
+            }
+        }
+        return stats;
+    }
+
+    const uint32_t *latency_histogram()
+    {
+        return __histogram;
+    }
+
+    void latency_reset()
+    {
+        memset(__histogram, 0, sizeof(__histogram));
+        memset(__stage_sum_us, 0, sizeof(__stage_sum_us));
+        __samples = 0;
+        __min_us = __max_us = __sum_us = 0;
+        __probe_state.store(PROBE_IDLE);
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <pico/time.h>
+#include <stdint.h>
+
+// input-to-photon latency: one encoder edge at a time is followed through the pipeline
+//   input    the encoder isr sees the edge
+//   consume  the game loop reads the counter into the frame it draws (frames are numbered by their swap)
+//   pickup   core1 takes that frame, or a later one when it was overwritten before core1 got to it
+//   present  the dma of that frame has completed (dma_done) and the leds have latched it (latched)
+// edges that arrive while one is followed are not sampled; the samples of a session build a histogram
+#ifndef LATENCY_BIN_US
+#define LATENCY_BIN_US 250
+#endif
+#ifndef LATENCY_BINS // the last bin collects everything longer
+#define LATENCY_BINS 128
+#endif
+
+namespace latency
+{
+    typedef enum
+    {
+        LATENCY_STAGE_CONSUME, // input to consume
+        LATENCY_STAGE_PICKUP,  // consume to pickup
+        LATENCY_STAGE_DMA,     // pickup to dma_done
+        LATENCY_STAGE_LATCH,   // dma_done to latched
+        LATENCY_STAGES,
+    } latency_stage_t;
+
+    typedef struct
+    {
+        uint32_t samples;
+        int64_t min_us, max_us, mean_us; // input to latched
+        int64_t p50_us, p90_us, p99_us;  // upper edges of the histogram bins, LATENCY_BIN_US resolution
+        int64_t stage_mean_us[LATENCY_STAGES];
+    } latency_stats_t;
+
+    void latency_input();                             // encoder isr
+    void latency_consume(const uint32_t generation); // core0; generation of the frame being drawn
+    void latency_pickup(const uint32_t generation);  // core1
+    void latency_present(const uint32_t generation, const absolute_time_t dma_done, const absolute_time_t latched); // core1
+
+    latency_stats_t latency_stats();
+    const uint32_t *latency_histogram(); // LATENCY_BINS counts of input to latched
+    void latency_reset();                // not while a probe is in flight on the other core
+}
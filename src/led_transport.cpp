@@ -0,0 +1,300 @@
+#include <string.h>
+
+#include "led_transport.hpp"
+#include "seqlock.hpp"
+
+#if LED_TRANSPORT == LED_TRANSPORT_SPI
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <hardware/spi.h>
+#endif
+#if LED_TRANSPORT == LED_TRANSPORT_SINK
+#include <stdio.h>
+#endif
+
+namespace led_transport
+{
+#if LED_TRANSPORT == LED_TRANSPORT_PIO
+    static const transport_timing_t __timing = {
+        800000,
+        ws2812::LEDS_PER_STRIP * ws2812::MAX_CHANNELS_PER_LED * 10, // 8 bits of 1.25 us per channel
+        ws2812::WS2812_RESET_US};
+
+#ifdef WS2812_PARALLEL
+    static int __frame_buffer_index = 0;
+#endif
+
+    bool transport_init()
+    {
+        return ws2812::WS2812_init();
+    }
+
+    void transport_begin_frame()
+    {
+    }
+
+    void transport_end_frame()
+    {
+#ifdef WS2812_PARALLEL
+        ws2812::led_colors_to_bitplanes(ws2812::led_strips_bitstream[__frame_buffer_index], (ws2812::led_color_t *)ws2812::led_colors);
+#endif
+    }
+
+    void transport_submit()
+    {
+#ifdef WS2812_PARALLEL
+        ws2812::transmit_led_colors_dma(__frame_buffer_index);
+        __frame_buffer_index ^= 1;
+#endif
+#ifdef WS2812_SINGLE
+        ws2812::transmit_led_colors();
+#endif
+    }
+
+    void transport_resubmit()
+    {
+#ifdef WS2812_PARALLEL
+        ws2812::transmit_led_colors_dma(__frame_buffer_index ^ 1);
+#endif
+#ifdef WS2812_SINGLE
+        ws2812::retransmit_led_colors();
+#endif
+    }
+
+    void transport_wait()
+    {
+        ws2812::wait_led_colors_transmitted();
+    }
+
+    transport_present_t transport_present()
+    {
+        const ws2812::led_colors_latch_t latch = ws2812::led_colors_last_latch();
+        return {latch.frames, latch.dma_done, latch.latched};
+    }
+
+    transport_stalls_t transport_stalls()
+    {
+        return {ws2812::led_colors_lock_stalls, ws2812::led_colors_fifo_stalls};
+    }
+#endif
+
+#if LED_TRANSPORT != LED_TRANSPORT_PIO
+    // backends without a completion irq publish the latch from transport_submit(), on the core that submits
+    static seqlock::seqlock_t<transport_present_t> __present = {};
+
+    static void __publish_present(const absolute_time_t dma_done, const absolute_time_t latched)
+    {
+        seqlock::seqlock_write(__present, [&](transport_present_t &present)
+                               {
+                                   present.frames++;
+                                   present.dma_done = dma_done;
+                                   present.latched = latched;
+                               });
+    }
+
+    transport_present_t transport_present()
+    {
+        return seqlock::seqlock_read(__present);
+    }
+#endif
+
+#if LED_TRANSPORT == LED_TRANSPORT_SPI
+    // apa102 frame: 32 zero bits, one word per led (0xe0 | 5-bit global brightness, b, g, r),
+    // then at least one clock edge per two leds to push the data through the chain
+    static const auto SPI_LEDS = ws2812::NMB_STRIPS * ws2812::LEDS_PER_STRIP;
+    static const auto SPI_START_BYTES = 4;
+    static const auto SPI_END_BYTES = (SPI_LEDS / 2 + 7) / 8;
+    static const auto SPI_FRAME_BYTES = SPI_START_BYTES + 4 * SPI_LEDS + SPI_END_BYTES;
+
+    static const transport_timing_t __timing = {
+        LED_TRANSPORT_SPI_BAUD,
+        (uint32_t)((uint64_t)SPI_FRAME_BYTES * 8 * 1000000 / LED_TRANSPORT_SPI_BAUD),
+        0};
+
+    // apa102 have a fixed bgr order of their own; the strips must keep the default format
+    constexpr bool spi_strip_formats_native()
+    {
+        for (int i = 0; i < ws2812::NMB_STRIPS; i++)
+        {
+            if (ws2812::STRIP_FORMATS[i] != ws2812::LED_FORMAT_GRB)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    static_assert(spi_strip_formats_native(), "spi leds use their own pixel format");
+
+    // one frame is framed while the other is sent
+    static uint8_t __spi_frame[2][SPI_FRAME_BYTES] __attribute__((aligned(4)));
+    static int __spi_active = 0;
+    static int __spi_dma_channel;
+
+    bool transport_init()
+    {
+        spi_init(spi0, LED_TRANSPORT_SPI_BAUD);
+        spi_set_format(spi0, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+        gpio_set_function(LED_TRANSPORT_SPI_SCK_PIN, GPIO_FUNC_SPI);
+        gpio_set_function(LED_TRANSPORT_SPI_TX_PIN, GPIO_FUNC_SPI);
+
+        for (int i = 0; i < 2; i++)
+        {
+            memset(__spi_frame[i], 0, SPI_START_BYTES + 4 * SPI_LEDS);
+            memset(__spi_frame[i] + SPI_START_BYTES + 4 * SPI_LEDS, 0xff, SPI_END_BYTES);
+        }
+
+        __spi_dma_channel = dma_claim_unused_channel(true);
+        dma_channel_config channel_config = dma_channel_get_default_config(__spi_dma_channel);
+        channel_config_set_transfer_data_size(&channel_config, DMA_SIZE_8);
+        channel_config_set_dreq(&channel_config, spi_get_dreq(spi0, true));
+        channel_config_set_read_increment(&channel_config, true);
+        channel_config_set_write_increment(&channel_config, false);
+        dma_channel_configure(
+            __spi_dma_channel,
+            &channel_config,
+            &spi_get_hw(spi0)->dr,
+            NULL, // set in transport_submit
+            SPI_FRAME_BYTES,
+            false);
+
+        ws2812::clear_led_colors();
+        return true;
+    }
+
+    void transport_begin_frame()
+    {
+    }
+
+    void transport_end_frame()
+    {
+        const ws2812::led_color_t *c = (const ws2812::led_color_t *)ws2812::led_colors;
+        uint8_t *p = __spi_frame[__spi_active] + SPI_START_BYTES;
+        for (int i = 0; i < SPI_LEDS; i++, c++, p += 4)
+        {
+            p[0] = 0xff;
+            p[1] = c->b;
+            p[2] = c->g;
+            p[3] = c->r;
+        }
+    }
+
+    // the dma is paced by the spi clock, so a frame has left frame_us after its start; it is published when
+    // the next frame waits for it
+    static bool __spi_sending = false;
+    static absolute_time_t __spi_start_time;
+    static transport_stalls_t __spi_stalls;
+
+    static void __spi_send(const uint8_t *frame)
+    {
+        stall::stall_enter(
+            __spi_stalls.fence,
+            []
+            { return !dma_channel_is_busy(__spi_dma_channel) && !spi_is_busy(spi0); },
+            []
+            { transport_wait(); });
+        if (__spi_sending)
+        {
+            const absolute_time_t dma_done = delayed_by_us(__spi_start_time, __timing.frame_us);
+            __publish_present(dma_done, delayed_by_us(dma_done, __timing.latch_us));
+        }
+        __spi_start_time = get_absolute_time();
+        __spi_sending = true;
+        dma_channel_set_read_addr(__spi_dma_channel, frame, true);
+    }
+
+    void transport_submit()
+    {
+        __spi_send(__spi_frame[__spi_active]);
+        __spi_active ^= 1;
+    }
+
+    void transport_resubmit()
+    {
+        __spi_send(__spi_frame[__spi_active ^ 1]);
+    }
+
+    void transport_wait()
+    {
+        dma_channel_wait_for_finish_blocking(__spi_dma_channel);
+        while (spi_is_busy(spi0))
+        {
+        }
+    }
+
+    transport_stalls_t transport_stalls()
+    {
+        return __spi_stalls;
+    }
+#endif
+
+#if LED_TRANSPORT == LED_TRANSPORT_SINK
+    static const transport_timing_t __timing = {0, 0, 0};
+
+    transport_sink_t transport_sink;
+    static FILE *__sink_file = nullptr;
+
+    bool transport_sink_open(const char *path)
+    {
+        if (__sink_file)
+        {
+            fclose(__sink_file);
+            __sink_file = nullptr;
+        }
+        if (path)
+        {
+            __sink_file = fopen(path, "wb");
+            return __sink_file != nullptr;
+        }
+        return true;
+    }
+
+    bool transport_init()
+    {
+        transport_sink.frames_submitted = 0;
+        memset(transport_sink.led_colors, 0, sizeof(transport_sink.led_colors));
+        return true;
+    }
+
+    void transport_begin_frame()
+    {
+    }
+
+    void transport_end_frame()
+    {
+    }
+
+    void transport_submit()
+    {
+        memcpy(transport_sink.led_colors, (const void *)ws2812::led_colors, sizeof(transport_sink.led_colors));
+        transport_sink.frames_submitted++;
+        if (__sink_file)
+        {
+            fwrite(transport_sink.led_colors, sizeof(transport_sink.led_colors), 1, __sink_file);
+            fflush(__sink_file);
+        }
+        const absolute_time_t now = get_absolute_time();
+        __publish_present(now, now);
+    }
+
+    void transport_resubmit()
+    {
+        transport_sink.frames_submitted++;
+        const absolute_time_t now = get_absolute_time();
+        __publish_present(now, now);
+    }
+
+    void transport_wait()
+    {
+    }
+
+    transport_stalls_t transport_stalls()
+    {
+        return {}; // frames are taken without waiting
+    }
+#endif
+
+    const transport_timing_t &transport_timing()
+    {
+        return __timing;
+    }
+}
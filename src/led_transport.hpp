@@ -0,0 +1,96 @@
+#pragma once
+
+#include <pico/time.h>
+#include <stdint.h>
+
+#include "stall.hpp"
+#include "ws2812.hpp"
+
+// led transport: moves the led_colors of a frame to the leds
+// the screen pipeline only talks to this interface; the backend is chosen at build time with LED_TRANSPORT
+#define LED_TRANSPORT_PIO 1  // ws2812 one-wire over pio, single or parallel as configured in ws2812.hpp
+#define LED_TRANSPORT_SPI 2  // apa102 / sk9822 clocked leds over hardware spi and dma, strips chained in strip order
+#define LED_TRANSPORT_SINK 3 // host builds: frames are kept in memory and optionally appended to a file
+
+#ifndef LED_TRANSPORT
+#ifdef HOST_BUILD
+#define LED_TRANSPORT LED_TRANSPORT_SINK
+#else
+#define LED_TRANSPORT LED_TRANSPORT_PIO
+#endif
+#endif
+
+#if LED_TRANSPORT == LED_TRANSPORT_SPI
+#ifndef LED_TRANSPORT_SPI_BAUD
+#define LED_TRANSPORT_SPI_BAUD 16000000
+#endif
+#ifndef LED_TRANSPORT_SPI_SCK_PIN
+#define LED_TRANSPORT_SPI_SCK_PIN 18
+#endif
+#ifndef LED_TRANSPORT_SPI_TX_PIN
+#define LED_TRANSPORT_SPI_TX_PIN 19
+#endif
+#endif
+
+namespace led_transport
+{
+    typedef struct
+    {
+        uint32_t bit_rate_hz; // per data line
+        uint32_t frame_us;    // time on the wire of one frame
+        uint32_t latch_us;    // quiet time after a frame before the leds show it
+    } transport_timing_t;
+
+    bool transport_init();
+
+    // led_colors may be written after this call
+    void transport_begin_frame();
+
+    // led_colors hold the complete frame; backend conversions (bit planes, spi framing) happen here
+    // called by the screen pipeline while it still owns the frame
+    void transport_end_frame();
+
+    // waits until the previous frame has left (the fence) and starts sending this one
+    void transport_submit();
+
+    // sends the last submitted frame again, without touching led_colors
+    void transport_resubmit();
+
+    // blocks until the last submitted frame has been latched by the leds
+    void transport_wait();
+
+    const transport_timing_t &transport_timing();
+
+    typedef struct
+    {
+        uint32_t frames;          // frames latched since init, resubmitted ones included
+        absolute_time_t dma_done; // of the last of them: when its data had left the dma
+        absolute_time_t latched;  // and when the leds showed it
+    } transport_present_t;
+
+    // the last frame the leds latched; frames are latched in the order they are submitted
+    // may be called from either core
+    transport_present_t transport_present();
+
+    // waits inside the transport: the fence on the previous frame, and the pio tx fifos (pio only)
+    typedef struct
+    {
+        stall::stall_counter_t fence;
+        stall::stall_counter_t fifo;
+    } transport_stalls_t;
+
+    transport_stalls_t transport_stalls();
+
+#if LED_TRANSPORT == LED_TRANSPORT_SINK
+    typedef struct
+    {
+        uint32_t frames_submitted;
+        ws2812::led_color_t led_colors[ws2812::NMB_STRIPS][ws2812::LEDS_PER_STRIP];
+    } transport_sink_t;
+
+    extern transport_sink_t transport_sink;
+
+    // raw frames of led_colors are appended to the file; nullptr closes it
+    bool transport_sink_open(const char *path);
+#endif
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "blend.hpp"
+#include "screen.hpp"
+
+// integer line rasteriser: Cohen-Sutherland clipping followed by an unchecked Bresenham loop,
+// and an anti-aliased Xiaolin Wu variant taking 8.8 fixed point coordinates
+namespace screen
+{
+    const auto LINE_FP_SHIFT = 8;
+    const auto LINE_FP_ONE = 1 << LINE_FP_SHIFT; // one pixel in 8.8 fixed point
+
+    enum line_outcode_t : uint8_t
+    {
+        LINE_INSIDE = 0,
+        LINE_LEFT = 1,
+        LINE_RIGHT = 2,
+        LINE_BOTTOM = 4, // y < 0
+        LINE_TOP = 8,    // y >= height
+    };
+
+    static inline uint8_t line_outcode(const int x, const int y, const int width, const int height)
+    {
+        uint8_t code = LINE_INSIDE;
+        if (x < 0)
+        {
+            code |= LINE_LEFT;
+        }
+        else if (x >= width)
+        {
+            code |= LINE_RIGHT;
+        }
+        if (y < 0)
+        {
+            code |= LINE_BOTTOM;
+        }
+        else if (y >= height)
+        {
+            code |= LINE_TOP;
+        }
+        return code;
+    }
+
+    // signed integer division rounded to the nearest integer
+    static inline int __line_div_round(const int n, const int d)
+    {
+        return ((n < 0) == (d < 0)) ? (n + d / 2) / d : (n - d / 2) / d;
+    }
+
+    // clips the segment to [0, width) x [0, height); returns false when nothing of it is visible
+    static inline bool clip_line(int &x0, int &y0, int &x1, int &y1, const int width = SCREEN_WIDTH, const int height = SCREEN_HEIGHT)
+    {
+        uint8_t code0 = line_outcode(x0, y0, width, height);
+        uint8_t code1 = line_outcode(x1, y1, width, height);
+
+        while (true)
+        {
+            if (!(code0 | code1))
+            {
+                return true;
+            }
+            if (code0 & code1)
+            {
+                return false;
+            }
+
+            // move the outside end point onto the boundary it crosses
+            const uint8_t code = code0 ? code0 : code1;
+            int x, y;
+            if (code & LINE_TOP)
+            {
+                y = height - 1;
+                x = x0 + __line_div_round((x1 - x0) * (y - y0), y1 - y0);
+            }
+            else if (code & LINE_BOTTOM)
+            {
+                y = 0;
+                x = x0 + __line_div_round((x1 - x0) * (y - y0), y1 - y0);
+            }
+            else if (code & LINE_RIGHT)
+            {
+                x = width - 1;
+                y = y0 + __line_div_round((y1 - y0) * (x - x0), x1 - x0);
+            }
+            else
+            {
+                x = 0;
+                y = y0 + __line_div_round((y1 - y0) * (x - x0), x1 - x0);
+            }
+
+            if (code == code0)
+            {
+                x0 = x;
+                y0 = y;
+                code0 = line_outcode(x0, y0, width, height);
+            }
+            else
+            {
+                x1 = x;
+                y1 = y;
+                code1 = line_outcode(x1, y1, width, height);
+            }
+        }
+    }
+
+    // Bresenham's line algorithm; after clipping every pixel is on screen, so no per pixel bounds checks
+    // draws into rgb, indexed and deep colour frame buffers alike
+    template <typename FRAME_BUFFER, typename COLOR>
+    static inline void draw_clipped_line(FRAME_BUFFER &fb, int x0, int y0, int x1, int y1, const COLOR c)
+    {
+        if (!clip_line(x0, y0, x1, y1))
+        {
+            return;
+        }
+
+        const int dx = abs(x1 - x0);
+        const int dy = abs(y1 - y0);
+        const int sx = x0 < x1 ? 1 : -1;
+        const int sy = y0 < y1 ? 1 : -1;
+        int err = dx - dy;
+
+        while (true)
+        {
+            fb[y0][x0] = c;
+            if (x0 == x1 && y0 == y1)
+            {
+                break;
+            }
+            const int e2 = 2 * err;
+            if (e2 > -dy)
+            {
+                err -= dy;
+                x0 += sx;
+            }
+            if (e2 < dx)
+            {
+                err += dx;
+                y0 += sy;
+            }
+        }
+    }
+
+    // Xiaolin Wu's anti-aliased line; coordinates are 8.8 fixed point with integer values at pixel centres
+    // each step of the major axis covers the two pixels straddling the line, weighted by their distance to it
+    // the coverage (8.8, LINE_FP_ONE for a pixel on the line) fades between the frame buffer and the blended colour
+    template <typename BLEND = blend_replace>
+    static inline void draw_line_aa(scr_frame_buffer_t &fb, int x0, int y0, int x1, int y1, const ws2812::led_color_t c, const BLEND &blend = BLEND())
+    {
+        const bool steep = abs(y1 - y0) > abs(x1 - x0);
+        if (steep)
+        {
+            int tmp = x0;
+            x0 = y0;
+            y0 = tmp;
+            tmp = x1;
+            x1 = y1;
+            y1 = tmp;
+        }
+        if (x0 > x1)
+        {
+            int tmp = x0;
+            x0 = x1;
+            x1 = tmp;
+            tmp = y0;
+            y0 = y1;
+            y1 = tmp;
+        }
+
+        const int major_size = steep ? SCREEN_HEIGHT : SCREEN_WIDTH;
+        const int minor_size = steep ? SCREEN_WIDTH : SCREEN_HEIGHT;
+
+        // clip the major axis; the minor axis is checked per pixel, a line may straddle the edge
+        int xs = (x0 + LINE_FP_ONE / 2) >> LINE_FP_SHIFT;
+        int xe = (x1 + LINE_FP_ONE / 2) >> LINE_FP_SHIFT;
+        if (xs < 0)
+        {
+            xs = 0;
+        }
+        if (xe >= major_size)
+        {
+            xe = major_size - 1;
+        }
+        if (xs > xe)
+        {
+            return;
+        }
+
+        // gradient and intercept in 16.16
+        const int dx = x1 - x0;
+        const int dy = y1 - y0;
+        const int32_t gradient = dx ? (int32_t)(((int64_t)dy << 16) / dx) : 0;
+        const pixel::px_t src = pixel::px_load(c);
+        int32_t intercept = (y0 << LINE_FP_SHIFT) + (int32_t)(((int64_t)gradient * ((xs << LINE_FP_SHIFT) - x0)) >> LINE_FP_SHIFT);
+
+        for (int x = xs; x <= xe; x++, intercept += gradient)
+        {
+            const int y = intercept >> 16;
+            const int coverage = (intercept >> 8) & 0xff; // of the pixel below the line, i.e. at y + 1
+            if (y >= 0 && y < minor_size)
+            {
+                blend_into(steep ? fb[x][y] : fb[y][x], src, blend, LINE_FP_ONE - coverage);
+            }
+            if (coverage && y + 1 >= 0 && y + 1 < minor_size)
+            {
+                blend_into(steep ? fb[x][y + 1] : fb[y + 1][x], src, blend, coverage);
+            }
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef HOST_BUILD
+#include "screen_primitives_mock.hpp"
+#else
+#include "screen_primitives.hpp"
+#endif
+
+namespace particles
+{
+    // fixed capacity particle pool (no heap), stored as struct-of-arrays
+    // live particles are kept packed in [0, count) so update and draw are plain linear loops
+    template <int CAPACITY>
+    class CParticlePool
+    {
+    private:
+        float x[CAPACITY];
+        float y[CAPACITY];
+        float vx[CAPACITY];
+        float vy[CAPACITY];
+        float life[CAPACITY];  // 1 when emitted, dead at 0
+        float decay[CAPACITY]; // life lost per second (1 / lifetime)
+        uint8_t r[CAPACITY];
+        uint8_t g[CAPACITY];
+        uint8_t b[CAPACITY];
+        int count;
+
+        void kill(const int i)
+        {
+            // move the last live particle into the hole
+            count--;
+            x[i] = x[count];
+            y[i] = y[count];
+            vx[i] = vx[count];
+            vy[i] = vy[count];
+            life[i] = life[count];
+            decay[i] = decay[count];
+            r[i] = r[count];
+            g[i] = g[count];
+            b[i] = b[count];
+        }
+
+    public:
+        CParticlePool() : count(0) {}
+
+        int size() const
+        {
+            return count;
+        }
+
+        static constexpr int capacity()
+        {
+            return CAPACITY;
+        }
+
+        void clear()
+        {
+            count = 0;
+        }
+
+        // returns false when the pool is full
+        bool emit(const float px, const float py, const float pvx, const float pvy, const float lifetime_s, const ws2812::led_color_t c)
+        {
+            if (count >= CAPACITY || lifetime_s <= 0)
+            {
+                return false;
+            }
+            x[count] = px;
+            y[count] = py;
+            vx[count] = pvx;
+            vy[count] = pvy;
+            life[count] = 1;
+            decay[count] = 1 / lifetime_s;
+            r[count] = c.r;
+            g[count] = c.g;
+            b[count] = c.b;
+            count++;
+            return true;
+        }
+
+        // emit n particles radially from (px, py) with speeds jittered between speed/2 and speed
+        int burst(const float px, const float py, const int n, const float speed, const float lifetime_s, const ws2812::led_color_t c)
+        {
+            int emitted = 0;
+            for (int i = 0; i < n; i++)
+            {
+                const float angle = (i + (rand() & 0xff) / 256.0f) * 2 * 3.14159f / n;
+                const float s = speed * (0.5f + (rand() & 0xff) / 512.0f);
+                emitted += emit(px, py, s * cosf(angle), s * sinf(angle), lifetime_s, c);
+            }
+            return emitted;
+        }
+
+        void update(const float delta_time_s)
+        {
+            // integrate without branches first, then compact the dead ones
+            for (int i = 0; i < count; i++)
+            {
+                x[i] += vx[i] * delta_time_s;
+                y[i] += vy[i] * delta_time_s;
+                life[i] -= decay[i] * delta_time_s;
+            }
+            for (int i = count - 1; i >= 0; i--)
+            {
+                if (life[i] <= 0)
+                {
+                    kill(i);
+                }
+            }
+        }
+
+        // additive blend, fading the colour with the remaining life; positions are floored, so a particle just past
+        // the left or top edge is off screen rather than on column or row 0
+        void draw() const
+        {
+            for (int i = 0; i < count; i++)
+            {
+                const int l = (int)(life[i] * 256);
+                screen::add_pixel((int)floorf(x[i]), (int)floorf(y[i]), ws2812_pack_color((r[i] * l) >> 8, (g[i] * l) >> 8, (b[i] * l) >> 8));
+            }
+        }
+    };
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <stdint.h>
+
+// led pixel formats: the order in which the colour channels go out on the wire, with 3 (rgb) or 4 (rgbw) channels
+// the frame buffers keep colours in led_color_t; the remap encodes them into wire words per strip, resolved at
+// compile time, and is a plain copy for the native grb order that led_color_t is laid out for
+namespace ws2812
+{
+    enum led_channel_t : uint8_t
+    {
+        LED_R = 0,
+        LED_G,
+        LED_B,
+        LED_W,
+    };
+
+#ifdef WS2812_PARALLEL
+    // bytes are sent in memory order
+    constexpr int led_wire_shift(const int position)
+    {
+        return 8 * position;
+    }
+#else
+    // each led is a 32-bit word shifted out msb first
+    constexpr int led_wire_shift(const int position)
+    {
+        return 24 - 8 * position;
+    }
+#endif
+
+    template <led_channel_t... ORDER>
+    struct led_format
+    {
+        static constexpr int CHANNELS = sizeof...(ORDER);
+        static constexpr led_channel_t order[CHANNELS] = {ORDER...};
+        static constexpr bool HAS_WHITE = ((ORDER == LED_W) || ...);
+
+        static_assert(CHANNELS == 3 || CHANNELS == 4, "leds have 3 or 4 channels");
+
+        static constexpr bool is_native()
+        {
+            return CHANNELS == 3 && order[0] == LED_G && order[1] == LED_R && order[2] == LED_B;
+        }
+
+        // the wire word of a colour; rgbw formats move the common part of r, g and b to the white channel
+        template <typename COLOR>
+        static inline uint32_t encode(const COLOR &c)
+        {
+            uint32_t word;
+            if constexpr (is_native())
+            {
+                static_assert(sizeof(COLOR) == sizeof(word), "");
+                __builtin_memcpy(&word, &c, sizeof(word));
+            }
+            else
+            {
+                uint8_t v[4] = {c.r, c.g, c.b, 0};
+                if constexpr (HAS_WHITE)
+                {
+                    const uint8_t w = v[0] < v[1] ? (v[0] < v[2] ? v[0] : v[2]) : (v[1] < v[2] ? v[1] : v[2]);
+                    v[0] -= w;
+                    v[1] -= w;
+                    v[2] -= w;
+                    v[3] = w;
+                }
+                word = 0;
+                for (int position = 0; position < CHANNELS; position++)
+                {
+                    word |= (uint32_t)v[order[position]] << led_wire_shift(position);
+                }
+            }
+            return word;
+        }
+    };
+
+    typedef led_format<LED_G, LED_R, LED_B> led_format_grb; // ws2812b
+    typedef led_format<LED_R, LED_G, LED_B> led_format_rgb;
+    typedef led_format<LED_B, LED_R, LED_G> led_format_brg;
+    typedef led_format<LED_G, LED_R, LED_B, LED_W> led_format_grbw; // sk6812 rgbw
+    typedef led_format<LED_R, LED_G, LED_B, LED_W> led_format_rgbw;
+
+    // formats selectable per strip
+    enum led_format_id_t : uint8_t
+    {
+        LED_FORMAT_GRB = 0,
+        LED_FORMAT_RGB,
+        LED_FORMAT_BRG,
+        LED_FORMAT_GRBW,
+        LED_FORMAT_RGBW,
+    };
+
+    constexpr int led_format_channels(const led_format_id_t id)
+    {
+        return (id == LED_FORMAT_GRBW || id == LED_FORMAT_RGBW) ? 4 : 3;
+    }
+
+    // calls f with a value of the format type, so per strip code is instantiated for each format;
+    // use as with_led_format(id, [&](auto format) { ... decltype(format)::encode(c) ... })
+    template <typename F>
+    static inline void with_led_format(const led_format_id_t id, F &&f)
+    {
+        switch (id)
+        {
+        case LED_FORMAT_RGB:
+            f(led_format_rgb());
+            break;
+        case LED_FORMAT_BRG:
+            f(led_format_brg());
+            break;
+        case LED_FORMAT_GRBW:
+            f(led_format_grbw());
+            break;
+        case LED_FORMAT_RGBW:
+            f(led_format_rgbw());
+            break;
+        default:
+            f(led_format_grb());
+            break;
+        }
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __ARM_FEATURE_SIMD32
+#include <arm_acle.h>
+#endif
+
+#include "ws2812.hpp"
+
+// packed pixel kernels: a whole led_color_t is processed as one 32-bit word
+// on the cortex-m33 the dsp extension does all four bytes per instruction (uqadd8, uhadd8, usub8 + sel, uxtb16);
+// elsewhere the same kernels fall back to portable swar arithmetic with identical results
+// px_multiply is the exception: both operands vary per channel, so it takes its four products one by one on every
+// target and only packs the rounding
+namespace pixel
+{
+    static_assert(sizeof(ws2812::led_color_t) == sizeof(uint32_t), "pixel kernels need 32-bit pixels");
+
+    typedef uint32_t px_t;
+
+    static inline px_t px_load(const ws2812::led_color_t &c)
+    {
+        px_t p;
+        memcpy(&p, &c, sizeof(p));
+        return p;
+    }
+
+    static inline void px_store(ws2812::led_color_t &c, const px_t p)
+    {
+        memcpy(&c, &p, sizeof(p));
+    }
+
+    // per byte min(a + b, 255)
+    static inline px_t px_add_sat(const px_t a, const px_t b)
+    {
+#ifdef __ARM_FEATURE_SIMD32
+        return __uqadd8(a, b);
+#else
+        const px_t low = (a & 0x7f7f7f7f) + (b & 0x7f7f7f7f);
+        const px_t sum = low ^ ((a ^ b) & 0x80808080);
+        const px_t carry = ((a & b) | ((a | b) & ~sum)) & 0x80808080;
+        return sum | ((carry >> 7) * 0xff);
+#endif
+    }
+
+    // per byte (a + b) >> 1
+    static inline px_t px_halving_add(const px_t a, const px_t b)
+    {
+#ifdef __ARM_FEATURE_SIMD32
+        return __uhadd8(a, b);
+#else
+        return (a & b) + (((a ^ b) >> 1) & 0x7f7f7f7f);
+#endif
+    }
+
+    // per byte max(a, b)
+    static inline px_t px_max(const px_t a, const px_t b)
+    {
+#ifdef __ARM_FEATURE_SIMD32
+        __usub8(a, b); // sets the ge flag of every byte where a >= b
+        return __sel(a, b);
+#else
+        // the low 7 bits are compared with a borrow that cannot cross bytes, the top bits decide where they differ
+        const px_t low_ge = (a | 0x80808080) - (b & 0x7f7f7f7f);
+        const px_t ge = ((a & ~b) | (~(a ^ b) & low_ge)) & 0x80808080;
+        const px_t m = (ge >> 7) * 0xff;
+        return (a & m) | (b & ~m);
+#endif
+    }
+
+    // bytes 0 and 2, and bytes 1 and 3, each widened into two 16-bit lanes
+    static inline px_t px_even_bytes(const px_t p)
+    {
+#ifdef __ARM_FEATURE_SIMD32
+        return __uxtb16(p);
+#else
+        return p & 0x00ff00ff;
+#endif
+    }
+
+    static inline px_t px_odd_bytes(const px_t p)
+    {
+#ifdef __ARM_FEATURE_SIMD32
+        return __uxtb16(__ror(p, 8));
+#else
+        return (p >> 8) & 0x00ff00ff;
+#endif
+    }
+
+    // per byte a * b / 255, rounded as (m + (m >> 8)) >> 8 with m = a * b + 128, in two 16-bit lanes at a time;
+    // m + (m >> 8) stays below 65536, so the lanes cannot overflow
+    static inline px_t px_multiply(const px_t a, const px_t b)
+    {
+        const px_t ae = px_even_bytes(a), be = px_even_bytes(b);
+        const px_t ao = px_odd_bytes(a), bo = px_odd_bytes(b);
+        px_t even = (((ae & 0xffff) * (be & 0xffff)) | (((ae >> 16) * (be >> 16)) << 16)) + 0x00800080;
+        px_t odd = (((ao & 0xffff) * (bo & 0xffff)) | (((ao >> 16) * (bo >> 16)) << 16)) + 0x00800080;
+        even = ((even + ((even >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+        odd = (odd + ((odd >> 8) & 0x00ff00ff)) & 0xff00ff00;
+        return even | odd;
+    }
+
+    // per byte (p * wp + c * wc) >> 8, with wp + wc <= 256
+    // each multiply scales two channels at once in their 16-bit lanes; the lanes cannot overflow
+    static inline px_t px_mix(const px_t p, const px_t c, const uint32_t wp, const uint32_t wc)
+    {
+        const px_t even = ((px_even_bytes(p) * wp + px_even_bytes(c) * wc) >> 8) & 0x00ff00ff;
+        const px_t odd = (px_odd_bytes(p) * wp + px_odd_bytes(c) * wc) & 0xff00ff00;
+        return even | odd;
+    }
+
+    // blends c over n pixels; c * wc is computed once for the whole run
+    static inline void px_mix_row(ws2812::led_color_t *p, const int n, const ws2812::led_color_t c, const uint32_t wp, const uint32_t wc)
+    {
+        const px_t c_even = px_even_bytes(px_load(c)) * wc;
+        const px_t c_odd = px_odd_bytes(px_load(c)) * wc;
+        for (int i = 0; i < n; i++)
+        {
+            const px_t q = px_load(p[i]);
+            const px_t even = ((px_even_bytes(q) * wp + c_even) >> 8) & 0x00ff00ff;
+            const px_t odd = (px_odd_bytes(q) * wp + c_odd) & 0xff00ff00;
+            px_store(p[i], even | odd);
+        }
+    }
+
+    // temporal dithering to 7 bits: out = (src + err) >> 1 and err = (src + err) & 1, per byte
+    // err must only hold 0 or 1 per byte, as left by the previous frame
+    static inline void px_dither_row(const ws2812::led_color_t *src, ws2812::led_color_t *err, ws2812::led_color_t *out, const int n)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            const px_t s = px_load(src[i]);
+            const px_t e = px_load(err[i]);
+            px_store(out[i], px_halving_add(s, e));
+            px_store(err[i], (s ^ e) & 0x01010101);
+        }
+    }
+
+    // ordered dithering: thresholds of an 8x8 bayer matrix, 2..254 in steps of 4, for the fraction of an 8.8 level
+    static const uint8_t PX_BAYER_8X8[8][8] = {
+        {2, 130, 34, 162, 10, 138, 42, 170},
+        {194, 66, 226, 98, 202, 74, 234, 106},
+        {50, 178, 18, 146, 58, 186, 26, 154},
+        {242, 114, 210, 82, 250, 122, 218, 90},
+        {14, 142, 46, 174, 6, 134, 38, 166},
+        {206, 78, 238, 110, 198, 70, 230, 102},
+        {62, 190, 30, 158, 54, 182, 22, 150},
+        {254, 126, 222, 94, 246, 118, 214, 86},
+    };
+
+    // the matrix is shifted every frame; frame * 37 runs through all 64 shifts, so over 64 frames
+    // each pixel meets every threshold once and shows its level to 1/64
+    static inline uint32_t px_bayer_threshold(const int x, const int y, const uint32_t frame)
+    {
+        const uint32_t shift = (frame * 37) & 63;
+        return PX_BAYER_8X8[(y + (shift >> 3)) & 7][(x + shift) & 7];
+    }
+
+    // an 8.8 level to 8 bits, rounded up when its fraction reaches the threshold
+    static inline uint8_t px_ordered_level(const uint32_t level, const uint32_t threshold)
+    {
+        const uint32_t v = (level + threshold) >> 8;
+        return v > 255 ? 255 : v;
+    }
+}
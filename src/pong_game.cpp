@@ -1,7 +1,12 @@
 #include <math.h>
 
+#include "display_list.hpp"
+#include "hud.hpp"
+#include "latency.hpp"
+#include "particles.hpp"
 #include "pong_game.hpp"
 #include "rotary_encoder.hpp"
+#include "screen_layers.hpp"
 #include "screen_primitives.hpp"
 
 namespace pong_game
@@ -99,7 +104,8 @@ namespace pong_game
 
         void draw()
         {
-            screen::draw_orb(pos_now.x, pos_now.y, radius, color);
+            // rasterised by core1
+            screen::dl_orb(pos_now.x, pos_now.y, radius, color);
         }
     };
 
@@ -114,7 +120,8 @@ namespace pong_game
 
         void draw()
         {
-            screen::draw_vertical_line(pos_now.x, pos_now.y - 2, pos_now.y + 2, color);
+            // rasterised by core1
+            screen::dl_line(pos_now.x, pos_now.y - 2, pos_now.x, pos_now.y + 2, color);
         }
 
         void update(const float delta_time_s)
@@ -150,6 +157,8 @@ namespace pong_game
         void score_point(const int player)
         {
             score[player]++;
+            // the score is part of the cached background
+            screen::scr_layers_invalidate();
         }
 
         bool is_over() const
@@ -169,27 +178,58 @@ namespace pong_game
         }
     };
 
-    const int brightness = 64;
+    // colour level; the master brightness is set in game_init(), the headroom above is left for additive effects
+    const int brightness = 128;
     static const ws2812::led_color_t COLOR_FIELD_LINE = ws2812_pack_color(brightness, brightness, (brightness / 2));
     static const ws2812::led_color_t COLOR_FIELD_LEFT = ws2812_pack_color((brightness / 2), 0, 0);
     static const ws2812::led_color_t COLOR_FIELD_RIGHT = ws2812_pack_color(0, 0, (brightness / 2));
     static const ws2812::led_color_t COLOR_BALL = ws2812_pack_color(brightness, brightness, brightness / 4);
     static const ws2812::led_color_t COLOR_PADDLE = ws2812_pack_color(brightness, brightness, brightness);
     static const ws2812::led_color_t COLOR_SCORE = ws2812_pack_color(brightness, brightness, brightness);
+    static const ws2812::led_color_t COLOR_SPARK = ws2812_pack_color(brightness, brightness / 2, 0);
 
     static float paddle_speed = .25;      // pixels per click
     static float ball_initial_speed = 20; // pixels per second
 
-    void game_init()
-    {
-        screen::scr_clear_screen();
-    }
-
     static CField field(0, 0, screen::SCREEN_WIDTH, screen::SCREEN_HEIGHT, COLOR_FIELD_LINE, COLOR_FIELD_LEFT, COLOR_FIELD_RIGHT);
     static CBall ball(CPoint(field.getSize().x / 2, field.getSize().y / 2), 1.5, CVector(ball_initial_speed, 0), COLOR_BALL);
     static CPaddle left_paddle(CPoint(field.getPosition().x, field.getPosition().y + field.getSize().y / 2), COLOR_PADDLE, field);
     static CPaddle right_paddle(CPoint(field.getPosition().x + field.getSize().x - 1, field.getPosition().y + field.getSize().y / 2), COLOR_PADDLE, field);
     static CMatch match(5, screen::SCREEN_WIDTH / 2, 2, COLOR_SCORE);
+    static particles::CParticlePool<384> effects;
+
+    static void draw_field_layer()
+    {
+        field.draw();
+        match.draw();
+    }
+
+    static void draw_objects_layer()
+    {
+        ball.draw();
+        left_paddle.draw();
+        right_paddle.draw();
+    }
+
+    static void draw_effects_layer()
+    {
+        effects.draw();
+    }
+
+    // field and score only change on a point, so they are cached as a static layer
+    // the ball and paddles are recorded into the display list and rasterised by core1 on top of the effects
+    static const screen::scr_layer_t layers[] = {
+        {draw_field_layer, true},
+        {draw_effects_layer, false},
+        {draw_objects_layer, false},
+    };
+
+    void game_init()
+    {
+        screen::scr_set_brightness(128);
+        screen::scr_clear_screen();
+        screen::scr_layers_init(layers, sizeof(layers) / sizeof(layers[0]));
+    }
 
     // Combine similar paddle collision code into a single function
     bool check_paddle_collision(const CPaddle& paddle, float prev_x, bool is_left_paddle) {
@@ -204,6 +244,7 @@ namespace pong_game
                 if ((is_left_paddle && ball.vel.x <= 0) || (!is_left_paddle && ball.vel.x >= 0)) {
                     ball.vel.rotate(-rotation);
                 }
+                effects.burst(paddle.pos_now.x, ball.pos_now.y, 12, 15, 0.3f, COLOR_SPARK);
                 return true;
             }
         }
@@ -214,6 +255,9 @@ namespace pong_game
     {
         const float delta_time_s = (float)delta_time_us / 1000000.0;
 
+        // the encoder counters below go into the frame that is swapped next
+        latency::latency_consume(screen::scr_screen_generation() + 1);
+
         int32_t rotary_1_delta = rotary_encoder::rotary_encoder_fetch_counter(&rotary_encoder::rotary_encoders[0]);
         // sw_1_state = rotary_encoder::rotary_encoder_fetch_sw_state(&rotary_encoder::rotary_encoders[0]);
         left_paddle.vel.y = rotary_1_delta * paddle_speed;
@@ -246,35 +290,33 @@ namespace pong_game
         if (ball.pos_now.x < field.getPosition().x)
         {
             match.score_point(1);
+            effects.burst(field.getPosition().x, ball.pos_now.y, 64, 30, 0.8f, COLOR_BALL);
             ball.vel.x = -ball.vel.x;
             ball.pos_prev = ball.pos_now = CPoint(field.getSize().x / 4, field.getSize().y / 2);
         }
         if (ball.pos_now.x >= field.getPosition().x + field.getSize().x)
         {
             match.score_point(0);
+            effects.burst(field.getPosition().x + field.getSize().x - 1, ball.pos_now.y, 64, 30, 0.8f, COLOR_BALL);
             ball.vel.x = -ball.vel.x;
             ball.pos_prev = ball.pos_now = CPoint(3 * field.getSize().x / 4, field.getSize().y / 2);
         }
+
+        effects.update(delta_time_s);
     }
 
     void game_draw(const bool gamma, const bool dither)
     {
-        screen::scr_clear_screen();
+        // restore the cached field and score, then draw the ball, paddles and effects
+        screen::scr_layers_compose();
 
-        // draw field
-        field.draw();
-
-        // draw score
-        match.draw();
-
-        // draw a ball
-        ball.draw();
-
-        // draw paddles
-        left_paddle.draw();
-        right_paddle.draw();
+        // the performance hud goes on top of all layers, when it is shown
+        hud::hud_draw();
 
         screen::scr_screen_swap(gamma, dither);
+
+        // the background of the next frame is copied by dma while core0 runs game_update()
+        screen::scr_layers_restore_async();
     }
 
     void game_exit()
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+// table-driven quadrature decoder, shared by the rotary encoder isr and the host tests
+namespace quadrature
+{
+    // indexed by (previous a/b state << 2) | current a/b state
+    // +1 clockwise, -1 counter clockwise, 0 no movement or invalid (bounce) transition
+    static const int8_t quadrature_table[16] = {
+        0,  // 00 -> 00
+        1,  // 00 -> 01
+        -1, // 00 -> 10
+        0,  // 00 -> 11
+        -1, // 01 -> 00
+        0,  // 01 -> 01
+        0,  // 01 -> 10
+        1,  // 01 -> 11
+        1,  // 10 -> 00
+        0,  // 10 -> 01
+        0,  // 10 -> 10
+        -1, // 10 -> 11
+        0,  // 11 -> 00
+        -1, // 11 -> 01
+        1,  // 11 -> 10
+        0,  // 11 -> 11
+    };
+
+    // advance the a/b trail with the current pin state (a << 1 | b) and return the counter delta
+    static inline int8_t quadrature_step(volatile uint8_t *a_b_trail, const uint8_t a_b)
+    {
+        const uint8_t trail = ((*a_b_trail << 2) | a_b) & 0xf;
+        *a_b_trail = trail;
+        return quadrature_table[trail];
+    }
+}
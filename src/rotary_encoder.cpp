@@ -1,14 +1,21 @@
 #include "hardware/gpio.h"
 
+#include "latency.hpp"
+#include "quadrature.hpp"
 #include "rotary_encoder.hpp"
 
 namespace rotary_encoder
 {
-#define NUM_ROTARY_ENCODERS 2
-    rotary_encoder rotary_encoders[] = {
-        {22, 26, 27, 0, 0, 0, ROTARY_ENCODER_SW_RELEASED},
-        {19, 20, 21, 0, 0, 0, ROTARY_ENCODER_SW_RELEASED},
-    };
+    rotary_encoder rotary_encoders[NUM_ROTARY_ENCODERS];
+
+    static const uint8_t rotary_encoder_pins[][3] = {
+        ROTARY_ENCODER_PINS};
+    static_assert(sizeof(rotary_encoder_pins) / sizeof(rotary_encoder_pins[0]) == NUM_ROTARY_ENCODERS,
+                  "ROTARY_ENCODER_PINS must list NUM_ROTARY_ENCODERS encoders");
+
+    // gpio -> index into rotary_encoders; -1 for pins that do not belong to an encoder
+    static const auto ROTARY_ENCODER_GPIO_COUNT = 32;
+    static int8_t gpio_to_encoder[ROTARY_ENCODER_GPIO_COUNT];
 
     int32_t rotary_encoder_fetch_counter(rotary_encoder *re)
     {
@@ -22,34 +29,21 @@ namespace rotary_encoder
         return re->sw_state;
     }
 
-    void static rotary_encoder_callback(uint gpio, __unused uint32_t events, rotary_encoder *re)
+    // isr for the rotary encoders
+    // the encoder is found in O(1) through gpio_to_encoder and all its pins are sampled with a single read
+    void rotary_encoders_callback(uint gpio, __unused uint32_t events)
     {
-        if (gpio == re->a || gpio == re->b)
+        if (gpio >= ROTARY_ENCODER_GPIO_COUNT || gpio_to_encoder[gpio] < 0)
         {
-            re->a_b_trail = ((re->a_b_trail << 2) | (gpio_get(re->a) << 1) | gpio_get(re->b)) & 0xf;
-
-            switch (re->a_b_trail)
-            {
-            case 0b0001:
-            case 0b0111:
-            case 0b1110:
-            case 0b1000:
-                // clockwise
-                (re->counter)++;
-                break;
-            case 0b0010:
-            case 0b1011:
-            case 0b1101:
-            case 0b0100:
-                // counter clockwise
-                (re->counter)--;
-                break;
-            }
+            return;
         }
 
+        rotary_encoder *re = &rotary_encoders[gpio_to_encoder[gpio]];
+        const uint32_t gpio_state = gpio_get_all();
+
         if (gpio == re->sw)
         {
-            re->sw_trail = ((re->sw_trail << 1) | gpio_get(re->sw)) & 0b11;
+            re->sw_trail = ((re->sw_trail << 1) | ((gpio_state >> re->sw) & 1)) & 0b11;
             switch (re->sw_trail)
             {
             case 0b10:
@@ -59,16 +53,16 @@ namespace rotary_encoder
                 re->sw_state = ROTARY_ENCODER_SW_RELEASED;
                 break;
             }
+            return;
         }
-    }
 
-    // isr for the rotary encoder
-    void rotary_encoders_callback(uint gpio, __unused uint32_t events)
-    {
-        for (int i = 0; i < NUM_ROTARY_ENCODERS; i++)
+        const uint8_t a_b = (((gpio_state >> re->a) & 1) << 1) | ((gpio_state >> re->b) & 1);
+        const int8_t step = quadrature::quadrature_step(&re->a_b_trail, a_b);
+        if (step)
         {
-            rotary_encoder_callback(gpio, events, &rotary_encoders[i]);
+            latency::latency_input();
         }
+        re->counter += step;
     }
 
     void static configure_rotary_encoder(rotary_encoder *re)
@@ -94,16 +88,38 @@ namespace rotary_encoder
 
     void rotary_encoders_init(void)
     {
+        // build the gpio -> encoder lookup table before any interrupt is enabled
+        for (int gpio = 0; gpio < ROTARY_ENCODER_GPIO_COUNT; gpio++)
+        {
+            gpio_to_encoder[gpio] = -1;
+        }
+        for (int i = 0; i < NUM_ROTARY_ENCODERS; i++)
+        {
+            rotary_encoders[i].a = rotary_encoder_pins[i][0];
+            rotary_encoders[i].b = rotary_encoder_pins[i][1];
+            rotary_encoders[i].sw = rotary_encoder_pins[i][2];
+            rotary_encoders[i].counter = 0;
+            rotary_encoders[i].sw_state = ROTARY_ENCODER_SW_RELEASED;
+
+            for (int p = 0; p < 3; p++)
+            {
+                const uint8_t gpio = rotary_encoder_pins[i][p];
+                hard_assert(gpio < ROTARY_ENCODER_GPIO_COUNT && gpio_to_encoder[gpio] < 0);
+                gpio_to_encoder[gpio] = i;
+            }
+        }
+
         for (int i = 0; i < NUM_ROTARY_ENCODERS; i++)
         {
             configure_rotary_encoder(&rotary_encoders[i]);
         }
 
         // read the initial state of the rotary encoder
+        const uint32_t gpio_state = gpio_get_all();
         for (int i = 0; i < NUM_ROTARY_ENCODERS; i++)
         {
-            rotary_encoders[i].a_b_trail = ((gpio_get(rotary_encoders[i].a) << 1) | gpio_get(rotary_encoders[i].b)) & 0xf;
-            rotary_encoders[i].sw_trail = (gpio_get(rotary_encoders[i].sw)) & 0b11;
+            rotary_encoders[i].a_b_trail = ((((gpio_state >> rotary_encoders[i].a) & 1) << 1) | ((gpio_state >> rotary_encoders[i].b) & 1)) & 0xf;
+            rotary_encoders[i].sw_trail = ((gpio_state >> rotary_encoders[i].sw) & 1) & 0b11;
         }
     }
-}
\ No newline at end of file
+}
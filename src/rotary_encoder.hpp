@@ -1,6 +1,23 @@
 #pragma once
 #include "hardware/gpio.h"
 
+// number of rotary encoders; can be overridden from the build (max 8, e.g. four-player walls)
+#ifndef NUM_ROTARY_ENCODERS
+#define NUM_ROTARY_ENCODERS 2
+#endif
+
+#if NUM_ROTARY_ENCODERS < 1 || NUM_ROTARY_ENCODERS > 8
+#error "NUM_ROTARY_ENCODERS must be between 1 and 8"
+#endif
+
+// a, b and sw pins of each rotary encoder; must list NUM_ROTARY_ENCODERS entries
+// all pins must be < 32 so that a single gpio_get_all() read covers them
+#ifndef ROTARY_ENCODER_PINS
+#define ROTARY_ENCODER_PINS \
+    {22, 26, 27},           \
+    {19, 20, 21}
+#endif
+
 namespace rotary_encoder
 {
 
@@ -22,7 +39,6 @@ namespace rotary_encoder
         ROTARY_ENCODER_SW_PRESSED,
     };
 
-#define NUM_ROTARY_ENCODERS 2
     extern rotary_encoder rotary_encoders[NUM_ROTARY_ENCODERS];
 
     int32_t rotary_encoder_fetch_counter(rotary_encoder *re);
@@ -30,4 +46,4 @@ namespace rotary_encoder
     uint8_t rotary_encoder_fetch_sw_state(rotary_encoder *re);
 
     void rotary_encoders_init(void);
-}
\ No newline at end of file
+}
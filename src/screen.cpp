@@ -1,9 +1,18 @@
+#include <atomic>
 #include <cmath>
-#include <hardware/dma.h>
 #include <pico/multicore.h>
 #include <pico/time.h>
+#include <string.h>
 
+#include "blit.hpp"
+#include "display_list.hpp"
+#include "latency.hpp"
+#include "led_transport.hpp"
+#include "pixel_kernels.hpp"
 #include "screen.hpp"
+#include "seqlock.hpp"
+#include "shard.hpp"
+#include "trace.hpp"
 
 namespace screen
 {
@@ -14,33 +23,180 @@ namespace screen
     ws2812::led_color_t (*__scr_screen_buffer)[SCREEN_HEIGHT][SCREEN_WIDTH]; // the screen buffer to send to the led strips
     // posted when it is safe to output a new set of values to ws2812
     mutex_t __mutex_processing_screen_buffer;
+    // display list recorded for __scr_screen_buffer; rasterised once by core1
+    static scr_display_list_t *volatile __scr_display_list_pending = nullptr;
     bool scr_gamma_correction = true;
     bool scr_dither = true;
 
+#if SCR_INDEXED_MODE
+    // indexed screen buffer and palettes
+    static uint8_t __scr_indexed_screen[2][SCREEN_HEIGHT][SCREEN_WIDTH] __attribute__((aligned(4)));
+    volatile static uint8_t __scr_indexed_active = 0;
+    scr_indexed_frame_buffer_t *scr_indexed_screen;
+    static scr_indexed_frame_buffer_t *__scr_indexed_buffer; // the indexed buffer to send to the led strips
+    ws2812::led_color_t scr_palette[SCR_PALETTE_SIZE];
+    static ws2812::led_color_t __scr_palette_pending[SCR_PALETTE_SIZE]; // copy of scr_palette taken at swap
+    static ws2812::led_color_t __scr_palette_lut[ws2812::NMB_STRIPS][SCR_PALETTE_SIZE]; // per strip corrected palette used by the remap
+    static volatile bool __scr_frame_indexed = false;                   // whether the frame in processing is indexed
+#else
+    static const bool __scr_frame_indexed = false; // so the checks of the frame mode need no #if
+#endif
+
+#if SCR_DEEP_COLOR
+    // deep colour screen buffer
+    static scr_deep_color_t __scr_deep_screen[2][SCREEN_HEIGHT][SCREEN_WIDTH] __attribute__((aligned(4)));
+    volatile static uint8_t __scr_deep_active = 0;
+    scr_deep_frame_buffer_t *scr_deep_screen;
+    static scr_deep_frame_buffer_t *__scr_deep_buffer; // the deep buffer to send to the led strips
+    static volatile bool __scr_frame_deep = false;     // whether the frame in processing is deep
+#else
+    static const bool __scr_frame_deep = false;
+#endif
+
+    // frame generation: bumped by every swap, so core1 knows when it is refreshing the same frame
+    static volatile uint32_t __scr_generation = 0;
+    // the time core1 holds the submit of the frame until, nil when it shows the frame as soon as it can
+    static absolute_time_t __scr_present_at;
+
+    // colour corrected leds of this board, kept while the frame does not change; __scr_screen_buffer stays untouched
+    // the pipeline buffers below cover the panel only, the frame buffers the whole canvas
+    static ws2812::led_color_t __scr_corrected[PANEL_HEIGHT][PANEL_WIDTH] __attribute__((aligned(4)));
+    // whether the tiles of the frame in processing run the colour correction stage or reuse __scr_corrected
+    static bool __scr_tiles_correct = true;
+
+#if SCR_DITHER_MODE == SCR_DITHER_TEMPORAL
     // dithering buffers
     static ws2812::led_color_t
-        __dth_e[SCREEN_HEIGHT][SCREEN_WIDTH],
-        __dth_v[SCREEN_HEIGHT][SCREEN_WIDTH];
+        __dth_e[PANEL_HEIGHT][PANEL_WIDTH],
+        __dth_v[PANEL_HEIGHT][PANEL_WIDTH];
+#else
+    // refresh counter that moves the ordered dither thresholds
+    static uint32_t __scr_dither_frame = 0;
+#endif
 
     // profile
     volatile scr_profile_t scr_profile;
+    scr_stalls_t scr_stalls;
+
+    // present feedback: core1 stamps every refresh as it takes the frame, and matches the frames the transport
+    // latched to the refreshes that submitted them
+    typedef struct
+    {
+        uint32_t generation;
+        absolute_time_t pickup;
+        bool new_frame;
+    } __scr_submit_t;
+    static __scr_submit_t __scr_submits[4]; // by submit count; a submit waits for the frame before it to be sent
+    static uint32_t __scr_submit_count = 0;
+    static uint32_t __scr_latched_count = 0;
+    typedef struct
+    {
+        scr_present_t present;
+        absolute_time_t pickup; // of the last refresh
+    } __scr_present_state_t;
+    static seqlock::seqlock_t<__scr_present_state_t> __scr_present = {};
 
     void scr_clear_screen()
     {
-        memset((void *)scr_screen, 0, sizeof(*scr_screen));
+        blit::blit_wait(blit::blit_clear(scr_screen));
     }
 
-    static uint8_t gamma8_lookup[256];
+#if SCR_INDEXED_MODE
+    void scr_clear_indexed_screen(const uint8_t index)
+    {
+        memset(scr_indexed_screen, index, sizeof(*scr_indexed_screen));
+    }
+#endif
+
+#if SCR_DEEP_COLOR
+    void scr_clear_deep_screen()
+    {
+        memset(scr_deep_screen, 0, sizeof(*scr_deep_screen));
+    }
+#endif
+
+    // colour correction: one lookup table per strip and channel, combining gamma, the strip's white point
+    // and the master brightness; the luts are rebuilt by core1 before the next frame when any of them changes
+    static float __scr_gamma;
+    static uint32_t __scr_gamma16[256]; // (i / 255) ^ gamma, 65536 is 1.0
+#if SCR_DEEP_COLOR
+    static uint32_t __scr_deep_gamma[257]; // (i / 256) ^ gamma, 65536 is 1.0; interpolated for 16-bit input
+#endif
+    static uint8_t __scr_brightness = 255;
+    static uint8_t __scr_white_point[ws2812::NMB_STRIPS][3];
+    static uint32_t __scr_power_limit = 256; // linear output scale set by the current limiter, 256 is 1.0
+    static volatile bool __scr_luts_dirty = true;
+    static uint8_t __scr_lut[ws2812::NMB_STRIPS][3][256]; // indexed by strip, then r, g, b
+    static uint32_t __scr_level_scale[ws2812::NMB_STRIPS][3]; // the same scale from the 0..65536 curve to 8.8 levels, for deep frames and ordered dither
+
     static void screen_set_gamma(float gamma)
     {
+        __scr_gamma = gamma;
         for (int i = 0; i < 256; i++)
         {
-            gamma8_lookup[i] = (uint8_t)(powf((float)i / 255.0f, gamma) * 255.0f + 0.5f);
+            __scr_gamma16[i] = (uint32_t)(powf((float)i / 255.0f, gamma) * 65536.0f + 0.5f);
         }
+#if SCR_DEEP_COLOR
+        for (int i = 0; i <= 256; i++)
+        {
+            __scr_deep_gamma[i] = (uint32_t)(powf((float)i / 256.0f, gamma) * 65536.0f + 0.5f);
+        }
+#endif
+        __scr_luts_dirty = true;
+    }
+
+    void scr_set_brightness(const uint8_t brightness)
+    {
+        __scr_brightness = brightness;
+        __scr_luts_dirty = true;
+    }
+
+    uint8_t scr_get_brightness()
+    {
+        return __scr_brightness;
+    }
+
+    void scr_set_white_point(const int strip, const uint8_t r, const uint8_t g, const uint8_t b)
+    {
+        if (strip < 0 || strip >= ws2812::NMB_STRIPS)
+        {
+            return;
+        }
+        __scr_white_point[strip][0] = r;
+        __scr_white_point[strip][1] = g;
+        __scr_white_point[strip][2] = b;
+        __scr_luts_dirty = true;
     }
 
-    static int _scr_dma_channel = -1;
-    const static auto _scr_word_multiple = sizeof(ws2812::led_color_t) % 4 == 0;
+    // power estimation and current limiting; the gamma pass (or the palette expansion of indexed frames)
+    // totals the corrected intensity of each channel, which the model below turns into a current estimate;
+    // without gamma correction the tiles total the raw channels, and the limiter, which scales the luts, is off
+    static scr_power_model_t __scr_power_model = {{12000, 12000, 12000}, 1000, SCR_POWER_BUDGET_MA};
+
+    void scr_set_power_model(const scr_power_model_t &model)
+    {
+        __scr_power_model = model;
+    }
+
+    // brightness is perceptual, i.e. applied before gamma; since (b * i) ^ gamma = b ^ gamma * i ^ gamma,
+    // it folds into a single linear scale per channel together with the white point, so no powf per entry
+    static void __scr_build_luts()
+    {
+        const float brightness = powf(__scr_brightness / 255.0f, __scr_gamma);
+        for (int strip = 0; strip < ws2812::NMB_STRIPS; strip++)
+        {
+            for (int channel = 0; channel < 3; channel++)
+            {
+                // 8.24 fixed point scale of the 0..65536 gamma curve to 0..255
+                const uint64_t scale = (uint64_t)(brightness * __scr_white_point[strip][channel] * 65536.0f + 0.5f) * __scr_power_limit >> 8;
+                __scr_level_scale[strip][channel] = scale >> 8;
+                for (int i = 0; i < 256; i++)
+                {
+                    __scr_lut[strip][channel][i] = (__scr_gamma16[i] * scale + (1u << 31)) >> 32;
+                }
+            }
+        }
+    }
 
     static void __scr_draw_screen();
     void __scr_screen_draw_loop()
@@ -53,12 +209,16 @@ namespace screen
 
     void scr_screen_init()
     {
-        ws2812::WS2812_init();
+        led_transport::transport_init();
+        blit::blit_init();
 
+        memset(__scr_white_point, 255, sizeof(__scr_white_point));
         screen_set_gamma(2.8);
 
+#if SCR_DITHER_MODE == SCR_DITHER_TEMPORAL
         memset(__dth_e, 0, sizeof(__dth_e));
         memset(__dth_v, 0, sizeof(__dth_v));
+#endif
 
         __scr_screen_active = 0;
         scr_screen = &(__scr_screen[__scr_screen_active]);
@@ -66,174 +226,807 @@ namespace screen
         __scr_screen_buffer = &(__scr_screen[1 - __scr_screen_active]);
         memset((void *)__scr_screen_buffer, 0, sizeof(*__scr_screen_buffer));
 
-        mutex_init(&__mutex_processing_screen_buffer);
-
-        _scr_dma_channel = dma_claim_unused_channel(true);
+#if SCR_INDEXED_MODE
+        __scr_indexed_active = 0;
+        scr_indexed_screen = &(__scr_indexed_screen[__scr_indexed_active]);
+        __scr_indexed_buffer = &(__scr_indexed_screen[1 - __scr_indexed_active]);
+#endif
 
-        const dma_channel_transfer_size transfer_size = _scr_word_multiple ? DMA_SIZE_32 : DMA_SIZE_8;
+#if SCR_DEEP_COLOR
+        __scr_deep_active = 0;
+        scr_deep_screen = &(__scr_deep_screen[__scr_deep_active]);
+        __scr_deep_buffer = &(__scr_deep_screen[1 - __scr_deep_active]);
+#endif
 
-        dma_channel_config channelConfig = dma_channel_get_default_config(_scr_dma_channel);
-        channel_config_set_transfer_data_size(&channelConfig, transfer_size);
-        channel_config_set_read_increment(&channelConfig, true);
-        channel_config_set_write_increment(&channelConfig, true);
-        dma_channel_configure(
-            _scr_dma_channel, // Channel to be configured
-            &channelConfig,   // The configuration we just created
-            NULL,             // The initial write address
-            NULL,             // The initial read address
-            0,                // Number of transfers; we will set this later
-            false);           // Don't start immediately
+        __scr_present_at = nil_time;
+        mutex_init(&__mutex_processing_screen_buffer);
 
         multicore_launch_core1(__scr_screen_draw_loop);
     }
 
-    void scr_screen_swap(const bool gamma, const bool dither)
-    {
-        mutex_enter_blocking(&__mutex_processing_screen_buffer);
-
-        scr_gamma_correction = gamma;
-        scr_dither = dither;
+    // gamma correction, dithering and remapping run per led matrix (tile), so both cores can share them
+    // a tile covers the pixels of one matrix; tiles are numbered strip_row * NMB_STRIP_COLUMNS + strip_col
+    const static auto NMB_TILES = ws2812::NMB_STRIP_ROWS * ws2812::NMB_STRIP_COLUMNS;
+    static_assert(ws2812::LED_MATRICES_PER_STRIP == 1, "tiles assume one led matrix per strip");
 
-        __scr_screen_buffer = scr_screen;
-
-        __scr_screen_active ^= 1;
-        scr_screen = &(__scr_screen[__scr_screen_active]);
+    inline void _gamma_correction(const int x0, const int y0, const uint8_t (&lut)[3][256], uint32_t (&intensity)[3])
+    {
+        uint32_t r = 0, g = 0, b = 0;
+        for (int y = y0; y < y0 + ws2812::LED_MATRIX_HEIGHT; y++)
+        {
+            for (int x = x0; x < x0 + ws2812::LED_MATRIX_WIDTH; x++)
+            {
+                const ws2812::led_color_t *pixel = &((*__scr_screen_buffer)[PANEL_Y0 + y][PANEL_X0 + x]);
+                ws2812::led_color_t *corrected = &__scr_corrected[y][x];
+                r += corrected->r = lut[0][pixel->r];
+                g += corrected->g = lut[1][pixel->g];
+                b += corrected->b = lut[2][pixel->b];
+            }
+        }
+        intensity[0] = r;
+        intensity[1] = g;
+        intensity[2] = b;
+    }
 
-        mutex_exit(&__mutex_processing_screen_buffer);
+    // without gamma correction the frame goes out as drawn; only its intensity is totalled for the estimate
+    inline void _raw_intensity(const int x0, const int y0, uint32_t (&intensity)[3])
+    {
+        uint32_t r = 0, g = 0, b = 0;
+        for (int y = y0; y < y0 + ws2812::LED_MATRIX_HEIGHT; y++)
+        {
+            for (int x = x0; x < x0 + ws2812::LED_MATRIX_WIDTH; x++)
+            {
+                const ws2812::led_color_t *pixel = &((*__scr_screen_buffer)[PANEL_Y0 + y][PANEL_X0 + x]);
+                r += pixel->r;
+                g += pixel->g;
+                b += pixel->b;
+            }
+        }
+        intensity[0] = r;
+        intensity[1] = g;
+        intensity[2] = b;
+    }
 
-        scr_clear_screen();
+#if SCR_DITHER_MODE == SCR_DITHER_TEMPORAL
+    // src is the panel origin of a buffer stride pixels wide
+    inline void _dithering(const ws2812::led_color_t *src, const int stride, const int x0, const int y0)
+    {
+        for (int y = y0; y < y0 + ws2812::LED_MATRIX_HEIGHT; y++)
+        {
+            pixel::px_dither_row(&src[y * stride + x0], &__dth_e[y][x0], &__dth_v[y][x0], ws2812::LED_MATRIX_WIDTH);
+        }
     }
 
-    inline void _gamma_correction()
+#if SCR_DEEP_COLOR
+    // the fraction of an 8.8 level is carried to the next frame in err (frame rate control)
+    static inline uint8_t _temporal_level(uint32_t level, uint8_t &err)
     {
-        for (int y = 0; y < SCREEN_HEIGHT; y++)
+        level += err;
+        err = level & 0xff;
+        level >>= 8;
+        return level > 255 ? 255 : level;
+    }
+#endif
+#else
+    // gamma correction and ordered dithering in one pass: the 8.8 level of the gamma curve is rounded
+    // against the bayer threshold of the pixel, so nothing is kept between frames
+    inline void _gamma_dither_correction(const int x0, const int y0, const uint32_t (&scale)[3], uint32_t (&intensity)[3])
+    {
+        uint32_t r = 0, g = 0, b = 0;
+        for (int y = y0; y < y0 + ws2812::LED_MATRIX_HEIGHT; y++)
         {
-            for (int x = 0; x < SCREEN_WIDTH; x++)
+            for (int x = x0; x < x0 + ws2812::LED_MATRIX_WIDTH; x++)
             {
-                ws2812::led_color_t *pixel = &((*__scr_screen_buffer)[y][x]);
-                pixel->r = gamma8_lookup[pixel->r];
-                pixel->g = gamma8_lookup[pixel->g];
-                pixel->b = gamma8_lookup[pixel->b];
+                const ws2812::led_color_t *pixel = &((*__scr_screen_buffer)[PANEL_Y0 + y][PANEL_X0 + x]);
+                ws2812::led_color_t *corrected = &__scr_corrected[y][x];
+                const uint32_t threshold = pixel::px_bayer_threshold(x, y, __scr_dither_frame);
+                r += corrected->r = pixel::px_ordered_level((__scr_gamma16[pixel->r] * scale[0]) >> 16, threshold);
+                g += corrected->g = pixel::px_ordered_level((__scr_gamma16[pixel->g] * scale[1]) >> 16, threshold);
+                b += corrected->b = pixel::px_ordered_level((__scr_gamma16[pixel->b] * scale[2]) >> 16, threshold);
             }
         }
+        intensity[0] = r;
+        intensity[1] = g;
+        intensity[2] = b;
+    }
+#endif
+
+#if SCR_DEEP_COLOR
+    // one channel of a deep pixel to an 8.8 level: gamma (interpolated between the 257 curve points) and scale
+    template <bool GAMMA>
+    static inline uint32_t _deep_level(const uint16_t v, const uint32_t scale)
+    {
+        if (GAMMA)
+        {
+            const uint32_t i = v >> 8;
+            const uint32_t linear = __scr_deep_gamma[i] + (((__scr_deep_gamma[i + 1] - __scr_deep_gamma[i]) * (v & 0xff)) >> 8);
+            return (linear * scale) >> 16;
+        }
+        return v - (v >> 8);
+    }
+
+    static inline uint8_t _rounded_level(const uint32_t level)
+    {
+        const uint32_t v = (level + 128) >> 8;
+        return v > 255 ? 255 : v;
     }
 
-    inline void _dithering()
+    // deep frames are corrected and dithered in one pass into __scr_corrected; the temporal dither keeps
+    // 8 bits of error per channel in __dth_e
+    template <bool GAMMA, bool DITHER>
+    void _deep_correction(const int x0, const int y0, const uint32_t (&scale)[3], uint32_t (&intensity)[3])
     {
-        for (int y = 0; y < SCREEN_HEIGHT; y++)
+        uint32_t r = 0, g = 0, b = 0;
+        for (int y = y0; y < y0 + ws2812::LED_MATRIX_HEIGHT; y++)
         {
-            for (int x = 0; x < SCREEN_WIDTH; x++)
+            for (int x = x0; x < x0 + ws2812::LED_MATRIX_WIDTH; x++)
             {
-                __dth_v[y][x].r = ((*__scr_screen_buffer)[y][x].r + __dth_e[y][x].r) >> 1;
-                __dth_v[y][x].g = ((*__scr_screen_buffer)[y][x].g + __dth_e[y][x].g) >> 1;
-                __dth_v[y][x].b = ((*__scr_screen_buffer)[y][x].b + __dth_e[y][x].b) >> 1;
-                __dth_e[y][x].r = ((*__scr_screen_buffer)[y][x].r + __dth_e[y][x].r) - (__dth_v[y][x].r << 1);
-                __dth_e[y][x].g = ((*__scr_screen_buffer)[y][x].g + __dth_e[y][x].g) - (__dth_v[y][x].g << 1);
-                __dth_e[y][x].b = ((*__scr_screen_buffer)[y][x].b + __dth_e[y][x].b) - (__dth_v[y][x].b << 1);
+                const scr_deep_color_t *pixel = &((*__scr_deep_buffer)[PANEL_Y0 + y][PANEL_X0 + x]);
+                ws2812::led_color_t *out = &__scr_corrected[y][x];
+                const uint32_t level_r = _deep_level<GAMMA>(pixel->r, scale[0]);
+                const uint32_t level_g = _deep_level<GAMMA>(pixel->g, scale[1]);
+                const uint32_t level_b = _deep_level<GAMMA>(pixel->b, scale[2]);
+                if (DITHER)
+                {
+#if SCR_DITHER_MODE == SCR_DITHER_TEMPORAL
+                    ws2812::led_color_t *err = &__dth_e[y][x];
+                    out->r = _temporal_level(level_r, err->r);
+                    out->g = _temporal_level(level_g, err->g);
+                    out->b = _temporal_level(level_b, err->b);
+#else
+                    const uint32_t threshold = pixel::px_bayer_threshold(x, y, __scr_dither_frame);
+                    out->r = pixel::px_ordered_level(level_r, threshold);
+                    out->g = pixel::px_ordered_level(level_g, threshold);
+                    out->b = pixel::px_ordered_level(level_b, threshold);
+#endif
+                }
+                else
+                {
+                    out->r = _rounded_level(level_r);
+                    out->g = _rounded_level(level_g);
+                    out->b = _rounded_level(level_b);
+                }
+                r += out->r;
+                g += out->g;
+                b += out->b;
             }
         }
+        intensity[0] = r;
+        intensity[1] = g;
+        intensity[2] = b;
     }
+#endif
 
+    // the copies below encode every pixel into the wire word of the strip's pixel format
+    template <typename FORMAT>
     static void inline _reverse_copy_pixels_to_led_colors(ws2812::led_color_t *led_colors, const ws2812::led_color_t *pixels, const int n)
     {
         pixels = pixels + n - 1;
         for (int i = 0; i < n; i++)
         {
-            *led_colors++ = *pixels--;
+            pixel::px_store(*led_colors++, FORMAT::encode(*pixels--));
         }
     }
 
+    template <typename FORMAT>
     static void inline _forward_copy_pixels_to_led_colors(ws2812::led_color_t *led_colors, const ws2812::led_color_t *pixels, const int n)
     {
-        dma_channel_wait_for_finish_blocking(_scr_dma_channel);
+        for (int i = 0; i < n; i++)
+        {
+            pixel::px_store(*led_colors++, FORMAT::encode(*pixels++));
+        }
+    }
 
-        const auto transfer_count = _scr_word_multiple ? n * sizeof(ws2812::led_color_t) / 4 : n * sizeof(ws2812::led_color_t);
-        dma_hw->ch[_scr_dma_channel].al2_transfer_count = transfer_count;
-        dma_hw->ch[_scr_dma_channel].al2_read_addr = (uint32_t)pixels;
-        dma_hw->ch[_scr_dma_channel].al2_write_addr_trig = (uint32_t)led_colors;
+#if SCR_INDEXED_MODE
+    // the indexed counterpart of the copies above; each index is expanded through the palette
+    template <typename FORMAT>
+    static void inline _reverse_expand_indices_to_led_colors(ws2812::led_color_t *led_colors, const uint8_t *indices, const ws2812::led_color_t *palette, const int n, uint32_t (&intensity)[3])
+    {
+        indices = indices + n - 1;
+        for (int i = 0; i < n; i++)
+        {
+            const ws2812::led_color_t c = palette[*indices--];
+            intensity[0] += c.r;
+            intensity[1] += c.g;
+            intensity[2] += c.b;
+            pixel::px_store(*led_colors++, FORMAT::encode(c));
+        }
     }
 
-    // this function copies the screen buffer to the led_colors buffer, following the specific arrangement of the led matrices
+    template <typename FORMAT>
+    static void inline _forward_expand_indices_to_led_colors(ws2812::led_color_t *led_colors, const uint8_t *indices, const ws2812::led_color_t *palette, const int n, uint32_t (&intensity)[3])
+    {
+        for (int i = 0; i < n; i++)
+        {
+            const ws2812::led_color_t c = palette[*indices++];
+            intensity[0] += c.r;
+            intensity[1] += c.g;
+            intensity[2] += c.b;
+            pixel::px_store(*led_colors++, FORMAT::encode(c));
+        }
+    }
+#endif
+
+    // this function copies one matrix of the screen buffer to the led_colors buffer, following the specific arrangement of the led matrices
     // ----------------------
     // | S0M1 | S1M1 | S2M1 |
     // |------|------|------|
     // | S0M0 | S1M0 | S2M0 |
     // ----------------------
-    // the screen buffer is assumed to be in the same format as the led_colors buffer
-    void screen_to_led_colors(ws2812::led_color_t *scr)
+    // pixels are encoded to the pixel format of the strip on the way; scr is the panel origin of a buffer stride pixels wide
+    template <typename FORMAT>
+    void tile_to_led_colors(const ws2812::led_color_t *scr, const int stride, const int strip_row, const int strip_col)
+    {
+        ws2812::led_color_t *led = (ws2812::led_color_t *)ws2812::led_colors + (strip_row * ws2812::NMB_STRIP_COLUMNS + strip_col) * ws2812::LEDS_PER_STRIP;
+        const ws2812::led_color_t *pixel = scr + (PANEL_HEIGHT - 1 - strip_row * ws2812::LED_MATRIX_HEIGHT) * stride + strip_col * ws2812::LED_MATRIX_WIDTH;
+        for (int matrix_row = 0; matrix_row < ws2812::LED_MATRIX_HEIGHT; matrix_row++)
+        {
+            if (matrix_row & 1)
+            {
+                _reverse_copy_pixels_to_led_colors<FORMAT>(led, pixel, ws2812::LED_MATRIX_WIDTH);
+            }
+            else
+            {
+                _forward_copy_pixels_to_led_colors<FORMAT>(led, pixel, ws2812::LED_MATRIX_WIDTH);
+            }
+            led += ws2812::LED_MATRIX_WIDTH;
+            pixel -= stride;
+        }
+    }
+
+#if SCR_INDEXED_MODE
+    // same as tile_to_led_colors(), for indexed frames
+    template <typename FORMAT>
+    void indexed_tile_to_led_colors(const uint8_t *scr, const int strip_row, const int strip_col, uint32_t (&intensity)[3])
+    {
+        intensity[0] = intensity[1] = intensity[2] = 0;
+        const int strip = strip_row * ws2812::NMB_STRIP_COLUMNS + strip_col;
+        ws2812::led_color_t *led = (ws2812::led_color_t *)ws2812::led_colors + strip * ws2812::LEDS_PER_STRIP;
+        const uint8_t *index = scr + (PANEL_HEIGHT - 1 - strip_row * ws2812::LED_MATRIX_HEIGHT) * SCREEN_WIDTH + strip_col * ws2812::LED_MATRIX_WIDTH;
+        for (int matrix_row = 0; matrix_row < ws2812::LED_MATRIX_HEIGHT; matrix_row++)
+        {
+            if (matrix_row & 1)
+            {
+                _reverse_expand_indices_to_led_colors<FORMAT>(led, index, __scr_palette_lut[strip], ws2812::LED_MATRIX_WIDTH, intensity);
+            }
+            else
+            {
+                _forward_expand_indices_to_led_colors<FORMAT>(led, index, __scr_palette_lut[strip], ws2812::LED_MATRIX_WIDTH, intensity);
+            }
+            led += ws2812::LED_MATRIX_WIDTH;
+            index -= SCREEN_WIDTH;
+        }
+    }
+
+    // palette stage of indexed frames: colour correction once per palette entry and strip
+    static void __scr_build_palette_lut()
     {
-        ws2812::led_color_t *pixel_base = scr + (SCREEN_HEIGHT - 1) * SCREEN_WIDTH;
-        for (int strip_row = 0; strip_row < ws2812::NMB_STRIP_ROWS; strip_row++)
+        for (int strip = 0; strip < ws2812::NMB_STRIPS; strip++)
         {
-            ws2812::led_color_t *led = (ws2812::led_color_t *)ws2812::led_colors + strip_row * ws2812::NMB_STRIP_COLUMNS * ws2812::LEDS_PER_STRIP;
-            ws2812::led_color_t *pixel = pixel_base - strip_row * ws2812::LED_MATRIX_HEIGHT * SCREEN_WIDTH;
-            for (int strip_col = 0; strip_col < ws2812::NMB_STRIP_COLUMNS; strip_col++)
+            for (int i = 0; i < SCR_PALETTE_SIZE; i++)
             {
-                for (int matrix_row = 0; matrix_row < ws2812::LED_MATRIX_HEIGHT; matrix_row++)
+                ws2812::led_color_t c = __scr_palette_pending[i];
+                if (scr_gamma_correction)
                 {
-                    if (matrix_row & 1)
-                    {
-                        _reverse_copy_pixels_to_led_colors(led, pixel, ws2812::LED_MATRIX_WIDTH);
-                    }
-                    else
-                    {
-                        _forward_copy_pixels_to_led_colors(led, pixel, ws2812::LED_MATRIX_WIDTH);
-                    }
-                    led += ws2812::LED_MATRIX_WIDTH;
-                    pixel -= SCREEN_WIDTH;
+                    c.r = __scr_lut[strip][0][c.r];
+                    c.g = __scr_lut[strip][1][c.g];
+                    c.b = __scr_lut[strip][2][c.b];
                 }
-                pixel += ws2812::LED_MATRIX_WIDTH + SCREEN_WIDTH * ws2812::LED_MATRIX_HEIGHT;
+                __scr_palette_lut[strip][i] = c;
             }
         }
     }
+#endif
+
+    // tile jobs of the frame being processed; __scr_next_tile >= NMB_TILES when there is nothing to claim
+    static std::atomic<int> __scr_next_tile(NMB_TILES);
+    static std::atomic<int> __scr_tiles_done(0);
+
+    // per core and per stage busy time of the current frame
+    static int64_t __scr_tile_time[2][3];
+    // per tile and channel sum of the corrected intensities of the current frame
+    static uint32_t __scr_tile_intensity[NMB_TILES][3];
+
+    static bool __scr_run_tile_job()
+    {
+        // claim a tile; compare-exchange so that idle polling never moves the counter past NMB_TILES
+        int tile = __scr_next_tile.load();
+        do
+        {
+            if (tile >= NMB_TILES)
+            {
+                return false;
+            }
+        } while (!__scr_next_tile.compare_exchange_weak(tile, tile + 1));
+
+        const auto core = get_core_num();
+        const int strip_row = tile / ws2812::NMB_STRIP_COLUMNS;
+        const int strip_col = tile % ws2812::NMB_STRIP_COLUMNS;
+        const int x0 = strip_col * ws2812::LED_MATRIX_WIDTH;
+        const int y0 = PANEL_HEIGHT - (strip_row + 1) * ws2812::LED_MATRIX_HEIGHT;
 
-#define PROFILE_CALL(func, timer)                                       \
+#if SCR_INDEXED_MODE
+        if (__scr_frame_indexed)
+        {
+            // gamma correction was done in the palette stage and indexed frames are not dithered
+            absolute_time_t t0 = get_absolute_time();
+            ws2812::with_led_format(ws2812::STRIP_FORMATS[tile], [&](auto format)
+                                    { indexed_tile_to_led_colors<decltype(format)>(&(*__scr_indexed_buffer)[PANEL_Y0][PANEL_X0], strip_row, strip_col, __scr_tile_intensity[tile]); });
+            __scr_tile_time[core][2] += absolute_time_diff_us(t0, get_absolute_time());
+
+            __scr_tiles_done.fetch_add(1);
+            return true;
+        }
+#endif
+
+#if SCR_DEEP_COLOR
+        if (__scr_frame_deep)
+        {
+            // the dither state lives in the 8.8 levels, so deep tiles are corrected on every refresh
+            absolute_time_t t0 = get_absolute_time();
+            if (scr_gamma_correction)
+            {
+                scr_dither ? _deep_correction<true, true>(x0, y0, __scr_level_scale[tile], __scr_tile_intensity[tile])
+                           : _deep_correction<true, false>(x0, y0, __scr_level_scale[tile], __scr_tile_intensity[tile]);
+            }
+            else
+            {
+                scr_dither ? _deep_correction<false, true>(x0, y0, __scr_level_scale[tile], __scr_tile_intensity[tile])
+                           : _deep_correction<false, false>(x0, y0, __scr_level_scale[tile], __scr_tile_intensity[tile]);
+            }
+            absolute_time_t t1 = get_absolute_time();
+            ws2812::with_led_format(ws2812::STRIP_FORMATS[tile], [&](auto format)
+                                    { tile_to_led_colors<decltype(format)>(&__scr_corrected[0][0], PANEL_WIDTH, strip_row, strip_col); });
+            absolute_time_t t2 = get_absolute_time();
+
+            __scr_tile_time[core][0] += absolute_time_diff_us(t0, t1);
+            __scr_tile_time[core][2] += absolute_time_diff_us(t1, t2);
+
+            __scr_tiles_done.fetch_add(1);
+            return true;
+        }
+#endif
+
+        absolute_time_t t0 = get_absolute_time();
+        if (__scr_tiles_correct)
+        {
+#if SCR_DITHER_MODE == SCR_DITHER_ORDERED
+            // the ordered dither rounds the fraction the gamma curve leaves, so it only applies with gamma correction
+            if (scr_gamma_correction && scr_dither)
+            {
+                _gamma_dither_correction(x0, y0, __scr_level_scale[tile], __scr_tile_intensity[tile]);
+            }
+            else
+#endif
+            if (scr_gamma_correction)
+            {
+                _gamma_correction(x0, y0, __scr_lut[tile], __scr_tile_intensity[tile]);
+            }
+            else
+            {
+                _raw_intensity(x0, y0, __scr_tile_intensity[tile]);
+            }
+        }
+        const ws2812::led_color_t *src = scr_gamma_correction ? &__scr_corrected[0][0] : &(*__scr_screen_buffer)[PANEL_Y0][PANEL_X0];
+        int stride = scr_gamma_correction ? PANEL_WIDTH : SCREEN_WIDTH;
+        absolute_time_t t1 = get_absolute_time();
+#if SCR_DITHER_MODE == SCR_DITHER_TEMPORAL
+        if (scr_dither)
+        {
+            _dithering(src, stride, x0, y0);
+            src = &__dth_v[0][0];
+            stride = PANEL_WIDTH;
+        }
+#endif
+        absolute_time_t t2 = get_absolute_time();
+        ws2812::with_led_format(ws2812::STRIP_FORMATS[tile], [&](auto format)
+                                { tile_to_led_colors<decltype(format)>(src, stride, strip_row, strip_col); });
+        absolute_time_t t3 = get_absolute_time();
+
+        __scr_tile_time[core][0] += absolute_time_diff_us(t0, t1);
+        __scr_tile_time[core][1] += absolute_time_diff_us(t1, t2);
+        __scr_tile_time[core][2] += absolute_time_diff_us(t2, t3);
+
+        __scr_tiles_done.fetch_add(1);
+        return true;
+    }
+
+    // estimates the current of the frame from the tile intensities and adjusts the limiter for the next frames
+    static void __scr_limit_power()
+    {
+        uint64_t channels_uA = 0;
+        for (int channel = 0; channel < 3; channel++)
+        {
+            uint32_t intensity = 0;
+            for (int tile = 0; tile < NMB_TILES; tile++)
+            {
+                intensity += __scr_tile_intensity[tile][channel];
+            }
+            channels_uA += (uint64_t)intensity * __scr_power_model.channel_uA[channel] / 255;
+        }
+        if (SCR_DITHER_MODE == SCR_DITHER_TEMPORAL && scr_dither && !__scr_frame_deep)
+        {
+            channels_uA >>= 1; // dithering sends (value + error) / 2
+        }
+        const uint32_t idle_mA = __scr_power_model.idle_uA * ws2812::NMB_STRIPS * ws2812::LEDS_PER_STRIP / 1000;
+        const uint32_t channels_mA = channels_uA / 1000;
+
+        scr_profile.power_estimate_mA = idle_mA + channels_mA;
+        scr_profile.power_limit = __scr_power_limit;
+
+        if (!__scr_power_model.budget_mA || !scr_gamma_correction)
+        {
+            if (__scr_power_limit != 256)
+            {
+                __scr_power_limit = 256;
+                __scr_luts_dirty = true;
+            }
+            return;
+        }
+
+        // what the frame would draw unlimited, and the scale that fits it into the budget
+        const uint32_t unlimited_mA = channels_mA * 256 / __scr_power_limit;
+        const uint32_t available_mA = __scr_power_model.budget_mA > idle_mA ? __scr_power_model.budget_mA - idle_mA : 0;
+        uint32_t limit = unlimited_mA > available_mA ? available_mA * 256 / unlimited_mA : 256;
+        if (limit < 1)
+        {
+            limit = 1;
+        }
+
+        // limit immediately, release with some hysteresis so the luts are not rebuilt on every frame
+        if (limit < __scr_power_limit || limit > __scr_power_limit + 4 || (limit == 256 && __scr_power_limit != 256))
+        {
+            __scr_power_limit = limit;
+            __scr_luts_dirty = true;
+        }
+    }
+
+    // core1 publishes the tiles of a frame and works on them; the other core helps while it waits in scr_screen_swap()
+    static void __scr_process_tiles()
+    {
+        memset(__scr_tile_time, 0, sizeof(__scr_tile_time));
+        __scr_tiles_done.store(0);
+        absolute_time_t start_time = get_absolute_time();
+
+        // lut and palette stages run before the tiles are published; they are accounted as gamma correction
+        if (__scr_luts_dirty)
+        {
+            __scr_luts_dirty = false;
+            __scr_build_luts();
+        }
+#if SCR_INDEXED_MODE
+        if (__scr_frame_indexed)
+        {
+            __scr_build_palette_lut();
+        }
+#endif
+        __scr_tile_time[get_core_num()][0] = absolute_time_diff_us(start_time, get_absolute_time());
+
+        __scr_next_tile.store(0);
+
+        while (__scr_run_tile_job())
+        {
+        }
+        while (__scr_tiles_done.load() < NMB_TILES)
+        {
+            tight_loop_contents();
+        }
+
+        scr_profile.time_pixel_pipeline = absolute_time_diff_us(start_time, get_absolute_time());
+        scr_profile.time_gamma_correction = __scr_tile_time[0][0] + __scr_tile_time[1][0];
+        scr_profile.time_dithering = __scr_tile_time[0][1] + __scr_tile_time[1][1];
+        scr_profile.time_screen_to_led_colors = __scr_tile_time[0][2] + __scr_tile_time[1][2];
+        scr_profile.time_tiles_core0 = __scr_tile_time[0][0] + __scr_tile_time[0][1] + __scr_tile_time[0][2];
+        scr_profile.time_tiles_core1 = __scr_tile_time[1][0] + __scr_tile_time[1][1] + __scr_tile_time[1][2];
+
+        // the intensities only change with the colour correction
+        if (__scr_tiles_correct || __scr_frame_deep)
+        {
+            __scr_limit_power();
+        }
+    }
+
+    // instead of blocking while core1 processes the previous frame, help it with its tiles
+    static void __scr_enter_processing_mutex()
+    {
+        trace::trace_begin(trace::TRACE_SWAP_WAIT);
+        auto try_enter = []
+        { return mutex_try_enter(&__mutex_processing_screen_buffer, NULL); };
+        stall::stall_enter_busy(scr_stalls.swap_lock, try_enter, [&]
+                                {
+                                    int64_t busy_us = 0;
+                                    while (!try_enter())
+                                    {
+                                        const absolute_time_t job_start = get_absolute_time();
+                                        if (__scr_run_tile_job())
+                                        {
+                                            busy_us += absolute_time_diff_us(job_start, get_absolute_time());
+                                        }
+                                        else
+                                        {
+                                            tight_loop_contents();
+                                        }
+                                    }
+                                    return busy_us;
+                                });
+        trace::trace_end(trace::TRACE_SWAP_WAIT);
+    }
+
+    void scr_screen_swap(const bool gamma, const bool dither)
+    {
+        scr_screen_swap_at(gamma, dither, nil_time);
+    }
+
+    void scr_screen_swap_at(const bool gamma, const bool dither, const absolute_time_t present_at)
+    {
+        __scr_enter_processing_mutex();
+
+        scr_gamma_correction = gamma;
+        scr_dither = dither;
+        __scr_present_at = present_at;
+#if SCR_INDEXED_MODE
+        __scr_frame_indexed = false;
+#endif
+#if SCR_DEEP_COLOR
+        __scr_frame_deep = false;
+#endif
+
+        __scr_screen_buffer = scr_screen;
+        __scr_display_list_pending = dl_swap();
+        __scr_generation++;
+
+        __scr_screen_active ^= 1;
+        scr_screen = &(__scr_screen[__scr_screen_active]);
+
+        mutex_exit(&__mutex_processing_screen_buffer);
+
+        // the new drawing buffer is not cleared here; each frame starts with
+        // scr_clear_screen() or scr_layers_compose(), which overwrite it anyway
+    }
+
+#if SCR_INDEXED_MODE
+    void scr_indexed_screen_swap(const bool gamma)
+    {
+        __scr_enter_processing_mutex();
+
+        scr_gamma_correction = gamma;
+        scr_dither = false;
+        __scr_frame_indexed = true;
+        __scr_present_at = nil_time;
+#if SCR_DEEP_COLOR
+        __scr_frame_deep = false;
+#endif
+
+        // the palette is copied, so core0 can change it for the next frame right away
+        memcpy(__scr_palette_pending, scr_palette, sizeof(__scr_palette_pending));
+        __scr_indexed_buffer = scr_indexed_screen;
+        __scr_generation++;
+
+        __scr_indexed_active ^= 1;
+        scr_indexed_screen = &(__scr_indexed_screen[__scr_indexed_active]);
+
+        mutex_exit(&__mutex_processing_screen_buffer);
+
+        // display list commands recorded meanwhile are kept for the next scr_screen_swap()
+    }
+#endif
+
+#if SCR_DEEP_COLOR
+    void scr_deep_screen_swap(const bool gamma, const bool dither)
+    {
+        __scr_enter_processing_mutex();
+
+        scr_gamma_correction = gamma;
+        scr_dither = dither;
+#if SCR_INDEXED_MODE
+        __scr_frame_indexed = false;
+#endif
+        __scr_frame_deep = true;
+        __scr_present_at = nil_time;
+
+        __scr_deep_buffer = scr_deep_screen;
+        __scr_generation++;
+
+        __scr_deep_active ^= 1;
+        scr_deep_screen = &(__scr_deep_screen[__scr_deep_active]);
+
+        mutex_exit(&__mutex_processing_screen_buffer);
+
+        // display list commands recorded meanwhile are kept for the next scr_screen_swap()
+    }
+#endif
+
+    static void __scr_smooth(int64_t &average, const int64_t sample)
+    {
+        average = average ? average + (sample - average) / 8 : sample;
+    }
+
+    // core1, when it takes the frame of a refresh
+    static void __scr_present_pickup()
+    {
+        const absolute_time_t now = get_absolute_time();
+        const led_transport::transport_present_t latch = led_transport::transport_present();
+
+        seqlock::seqlock_write(__scr_present, [&](__scr_present_state_t &state)
+                               {
+                                   if (__scr_submit_count)
+                                   {
+                                       __scr_smooth(state.present.refresh_us, absolute_time_diff_us(state.pickup, now));
+                                   }
+                                   state.pickup = now;
+                                   if (latch.frames != __scr_latched_count)
+                                   {
+                                       __scr_latched_count = latch.frames;
+                                       const __scr_submit_t &submit = __scr_submits[(latch.frames - 1) & 3];
+                                       state.present.generation = submit.generation;
+                                       state.present.dma_done = latch.dma_done;
+                                       state.present.latched = latch.latched;
+                                       latency::latency_present(submit.generation, latch.dma_done, latch.latched);
+                                       // resubmitted frames skip the pixel pipeline, so they would shorten the estimate
+                                       if (submit.new_frame)
+                                       {
+                                           __scr_smooth(state.present.pipeline_us, absolute_time_diff_us(submit.pickup, latch.latched));
+                                       }
+                                   }
+                               });
+    }
+
+    // core1, before each submit and resubmit; the transport latches them in the same order
+    static void __scr_present_submit(const uint32_t generation, const bool new_frame)
+    {
+        __scr_submits[__scr_submit_count++ & 3] = {generation, __scr_present.value.pickup, new_frame};
+    }
+
+    scr_present_t scr_last_present()
+    {
+        return seqlock::seqlock_read(__scr_present).present;
+    }
+
+    uint32_t scr_screen_generation()
+    {
+        return __scr_generation;
+    }
+
+    // core1 takes the frame at its first refresh after the swap, and the leds show it a pipeline later
+    absolute_time_t scr_predict_present(const absolute_time_t swap_time)
+    {
+        const __scr_present_state_t state = seqlock::seqlock_read(__scr_present);
+        const scr_present_t &present = state.present;
+        const absolute_time_t pickup = state.pickup;
+
+        int64_t wait = absolute_time_diff_us(pickup, swap_time);
+        if (wait > 0 && present.refresh_us > 0)
+        {
+            wait = (wait + present.refresh_us - 1) / present.refresh_us * present.refresh_us;
+        }
+        else
+        {
+            wait = 0;
+        }
+        return delayed_by_us(pickup, wait + present.pipeline_us);
+    }
+
+    void scr_wait_refresh()
+    {
+        seqlock::seqlock_wait_write(__scr_present);
+    }
+
+#define PROFILE_CALL(func, timer, name)                                 \
     {                                                                   \
+        trace::trace_begin(name);                                       \
         absolute_time_t start_time = get_absolute_time();               \
         func;                                                           \
         timer = absolute_time_diff_us(start_time, get_absolute_time()); \
+        trace::trace_end(name);                                         \
     }
 
     static void __scr_draw_screen()
     {
-        mutex_enter_blocking(&__mutex_processing_screen_buffer);
-#ifdef WS2812_PARALLEL
-        static int frame_buffer_index = 0;
+        static uint32_t generation_drawn = ~0u;
+
+        stall::stall_enter(
+            scr_stalls.draw_lock,
+            []
+            { return mutex_try_enter(&__mutex_processing_screen_buffer, NULL); },
+            []
+            { mutex_enter_blocking(&__mutex_processing_screen_buffer); });
+        __scr_present_pickup();
+
+        const led_transport::transport_stalls_t transport_stalls = led_transport::transport_stalls();
+        scr_stalls.transmit_fence = transport_stalls.fence;
+        scr_stalls.tx_fifo = transport_stalls.fifo;
+
+        // the same frame again: only the temporal dither moves, unless the colour correction changed
+        const bool new_frame = __scr_generation != generation_drawn;
+        if (new_frame)
+        {
+            scr_stalls.frames_dropped += __scr_generation - generation_drawn - 1;
+            latency::latency_pickup(__scr_generation);
+        }
+        else
+        {
+            scr_stalls.frames_repeated++;
+        }
+        generation_drawn = __scr_generation;
+        __scr_tiles_correct = new_frame || __scr_luts_dirty;
+#if SCR_DITHER_MODE == SCR_DITHER_ORDERED
+        // the thresholds move with every refresh; a dithered frame is corrected again from its untouched source
+        __scr_dither_frame++;
+        __scr_tiles_correct = __scr_tiles_correct || (scr_dither && scr_gamma_correction);
 #endif
+        if (!__scr_tiles_correct && !scr_dither)
+        {
+            mutex_exit(&__mutex_processing_screen_buffer);
+            __scr_present_submit(generation_drawn, false);
+            PROFILE_CALL(
+                led_transport::transport_resubmit(),
+                scr_profile.time_wait_for_DMA,
+                trace::TRACE_RESUBMIT);
+            return;
+        }
 
-        // apply gamma correction
-        PROFILE_CALL(
-            scr_gamma_correction ? _gamma_correction() : void(),
-            scr_profile.time_gamma_correction);
+#if SCR_DITHER_MODE == SCR_DITHER_TEMPORAL && SCR_DEEP_COLOR
+        // the two dithers keep different errors: 1 bit for 8-bit frames, 8 bits for deep frames
+        static bool deep_drawn = false;
+        if (__scr_frame_deep != deep_drawn)
+        {
+            deep_drawn = __scr_frame_deep;
+            memset(__dth_e, 0, sizeof(__dth_e));
+        }
+#endif
 
-        // apply dithering
-        PROFILE_CALL(
-            scr_dither ? _dithering() : void(),
-            scr_profile.time_dithering);
+        led_transport::transport_begin_frame();
 
-        // convert the screen buffer to led colors
-        PROFILE_CALL(
-            screen_to_led_colors(scr_dither ? (ws2812::led_color_t *)__dth_v : (ws2812::led_color_t *)__scr_screen_buffer),
-            scr_profile.time_screen_to_led_colors);
+        // rasterise the display list recorded by core0 on top of the frame
+        if (!__scr_frame_indexed && !__scr_frame_deep && __scr_display_list_pending)
+        {
+            PROFILE_CALL(
+                dl_rasterise(__scr_display_list_pending, *__scr_screen_buffer),
+                scr_profile.time_rasterise,
+                trace::TRACE_RASTERISE);
+            __scr_display_list_pending = nullptr;
+        }
 
-        // convert the colors to bit planes
-#ifdef WS2812_PARALLEL
-        PROFILE_CALL(
-            led_colors_to_bitplanes(ws2812::led_strips_bitstream[frame_buffer_index], (ws2812::led_color_t *)ws2812::led_colors),
-            scr_profile.time_led_colors_to_bitplanes);
+        // a frame with a present deadline is held at its submit, so that every panel of a sharded display latches it
+        // at the same time; refreshes of a frame already shown are not held
+        absolute_time_t present_at = new_frame ? __scr_present_at : nil_time;
+#if SHARD_ROLE == SHARD_ROLE_MASTER
+        // the followers get the frame before colour correction, which each board does for its own leds; the link
+        // sends it while the tiles below run, and this board holds its own part to the same deadline
+        if (new_frame && !__scr_frame_indexed && !__scr_frame_deep)
+        {
+            shard::shard_master_send_frame(&(*__scr_screen_buffer)[0][0], SCREEN_WIDTH, present_at);
+        }
 #endif
-        mutex_exit(&__mutex_processing_screen_buffer);
 
-#ifdef WS2812_PARALLEL
+        // apply gamma correction and dithering, and convert the screen buffer to led colors, tile by tile
+        trace::trace_begin(trace::TRACE_TILES);
+        __scr_process_tiles();
+        trace::trace_end(trace::TRACE_TILES);
+
+        // transport specific conversion, e.g. the bit planes of parallel strips
         PROFILE_CALL(
-            ws2812::transmit_led_colors_dma(frame_buffer_index),
-            scr_profile.time_wait_for_DMA);
-        frame_buffer_index ^= 1;
-#endif
-#ifdef WS2812_SINGLE
+            led_transport::transport_end_frame(),
+            scr_profile.time_led_colors_to_bitplanes,
+            trace::TRACE_END_FRAME);
+        mutex_exit(&__mutex_processing_screen_buffer);
+
+        if (!is_nil_time(present_at))
+        {
+            trace::trace_begin(trace::TRACE_PRESENT_HOLD);
+            stall::stall_enter(
+                scr_stalls.present_hold,
+                [&]
+                { return time_reached(present_at); },
+                [&]
+                { busy_wait_until(present_at); });
+            trace::trace_end(trace::TRACE_PRESENT_HOLD);
+        }
+
+        __scr_present_submit(generation_drawn, new_frame);
         PROFILE_CALL(
-            ws2812::transmit_led_colors(),
-            scr_profile.time_wait_for_DMA);
-#endif
+            led_transport::transport_submit(),
+            scr_profile.time_wait_for_DMA,
+            trace::TRACE_SUBMIT);
     }
 }
\ No newline at end of file
@@ -1,30 +1,173 @@
 #pragma once
+#include <pico/time.h>
 #include <string.h>
 
 #include "ws2812.hpp"
 
+#ifndef SCR_POWER_BUDGET_MA
+#define SCR_POWER_BUDGET_MA 0 // current the led supply can deliver; 0 disables the current limiter
+#endif
+
+// dithering of the frames swapped with dither set
+#define SCR_DITHER_TEMPORAL 1 // error carried to the next frame, in two frame-sized buffers
+#define SCR_DITHER_ORDERED 2  // a moving bayer threshold added in the gamma pass; no per pixel state
+#ifndef SCR_DITHER_MODE
+#define SCR_DITHER_MODE SCR_DITHER_TEMPORAL
+#endif
+
+#ifndef SCR_INDEXED_MODE
+#define SCR_INDEXED_MODE 0 // 1 adds the indexed colour frame buffers and palettes (about 11 KB of sram)
+#endif
+
+#ifndef SCR_DEEP_COLOR
+#define SCR_DEEP_COLOR 0 // 1 adds the 16-bit per channel frame buffers (about 18 KB of sram)
+#endif
+
+// the canvas the game draws on; by default exactly the leds of this board, larger on the master of a
+// sharded display (see shard.hpp), whose own leds show the window at SCR_PANEL_X0, SCR_PANEL_Y0
+#ifndef SCR_CANVAS_WIDTH
+#define SCR_CANVAS_WIDTH (ws2812::LED_MATRIX_WIDTH * ws2812::NMB_STRIP_COLUMNS)
+#endif
+#ifndef SCR_CANVAS_HEIGHT
+#define SCR_CANVAS_HEIGHT (ws2812::LED_MATRIX_HEIGHT * ws2812::NMB_STRIP_ROWS)
+#endif
+#ifndef SCR_PANEL_X0
+#define SCR_PANEL_X0 0
+#endif
+#ifndef SCR_PANEL_Y0
+#define SCR_PANEL_Y0 0
+#endif
+
 namespace screen
 {
-    const auto SCREEN_WIDTH = ws2812::LED_MATRIX_WIDTH * 3;
-    const auto SCREEN_HEIGHT = ws2812::LED_MATRIX_HEIGHT * 2;
+    const auto SCREEN_WIDTH = SCR_CANVAS_WIDTH;
+    const auto SCREEN_HEIGHT = SCR_CANVAS_HEIGHT;
+
+    // the leds of this board, and where they are on the canvas
+    const auto PANEL_WIDTH = ws2812::LED_MATRIX_WIDTH * ws2812::NMB_STRIP_COLUMNS;
+    const auto PANEL_HEIGHT = ws2812::LED_MATRIX_HEIGHT * ws2812::NMB_STRIP_ROWS;
+    const auto PANEL_X0 = SCR_PANEL_X0;
+    const auto PANEL_Y0 = SCR_PANEL_Y0;
+    static_assert(PANEL_X0 >= 0 && PANEL_Y0 >= 0 && PANEL_X0 + PANEL_WIDTH <= SCREEN_WIDTH && PANEL_Y0 + PANEL_HEIGHT <= SCREEN_HEIGHT,
+                  "the leds of this board must be on the canvas");
 
     extern bool scr_gamma_correction;
     extern bool scr_dither;
 
+    typedef ws2812::led_color_t scr_frame_buffer_t[SCREEN_HEIGHT][SCREEN_WIDTH];
+
     extern ws2812::led_color_t (*scr_screen)[SCREEN_HEIGHT][SCREEN_WIDTH];
 
+    // indexed colour mode: primitives write 1-byte palette indices and core1 expands them to led colors
+    // during the remap; gamma correction is applied once per palette entry instead of once per pixel
+    const auto SCR_PALETTE_SIZE = 256;
+    typedef uint8_t scr_indexed_frame_buffer_t[SCREEN_HEIGHT][SCREEN_WIDTH];
+
+#if SCR_INDEXED_MODE
+    extern scr_indexed_frame_buffer_t *scr_indexed_screen;
+    extern ws2812::led_color_t scr_palette[SCR_PALETTE_SIZE]; // taken over by core1 at each indexed swap
+#endif
+
+    // deep colour mode: 16 bits per channel (65535 is full scale), in the same perceptual space as led_color_t;
+    // core1 corrects through a 16-bit gamma curve and dithers the result over time down to the 8-bit leds,
+    // so dim colours and gradients keep shades that the 8-bit lut would round to the same level
+    typedef struct
+    {
+        uint16_t r, g, b;
+    } scr_deep_color_t;
+    typedef scr_deep_color_t scr_deep_frame_buffer_t[SCREEN_HEIGHT][SCREEN_WIDTH];
+
+#if SCR_DEEP_COLOR
+    extern scr_deep_frame_buffer_t *scr_deep_screen;
+#endif
+
+    static inline scr_deep_color_t scr_deep_color(const uint16_t r, const uint16_t g, const uint16_t b)
+    {
+        return {r, g, b};
+    }
+
+    static inline scr_deep_color_t scr_deep_color(const ws2812::led_color_t c)
+    {
+        return {(uint16_t)(c.r * 257), (uint16_t)(c.g * 257), (uint16_t)(c.b * 257)};
+    }
+
     typedef struct screen
     {
+        int64_t time_rasterise;
         int64_t time_gamma_correction;
         int64_t time_dithering;
         int64_t time_screen_to_led_colors;
         int64_t time_led_colors_to_bitplanes;
         int64_t time_wait_for_DMA;
+        int64_t time_pixel_pipeline; // wall time of gamma correction, dithering and remap, shared by both cores
+        int64_t time_tiles_core0;    // busy time of each core on the tiles above
+        int64_t time_tiles_core1;
+        int64_t power_estimate_mA; // estimated current of the last frame
+        int64_t power_limit;       // output scale of the current limiter, 256 when not limiting
     } scr_profile_t;
 
     extern volatile scr_profile_t scr_profile;
 
+    // where the frame pipeline waits, per core (see stall.hpp), and how frames pass from core0 to core1;
+    // long swap_lock waits mean core0 is ahead of the pixel pipeline, long fence waits that the wire is the limit
+    typedef struct
+    {
+        stall::stall_counter_t swap_lock;     // core0 in the swaps, waiting for core1 to release the frame; busy_us is tile work
+        stall::stall_counter_t draw_lock;     // core1 waiting for a swap to finish
+        stall::stall_counter_t transmit_fence; // the transport waiting for the previous frame, with its reset delay
+        stall::stall_counter_t tx_fifo;       // pio state machines waiting for the dma to fill their tx fifos
+        stall::stall_counter_t present_hold;  // core1 holding a frame until its present deadline; entries that did not wait were late
+        uint32_t frames_dropped;              // swapped frames that were replaced before core1 took them
+        uint32_t frames_repeated;             // refreshes that showed the frame of the previous refresh again
+    } scr_stalls_t;
+
+    extern scr_stalls_t scr_stalls; // updated by core1 at every refresh
+
     void scr_screen_init();
     void scr_clear_screen();
-    void scr_screen_swap(const bool gamma, const bool dither); // signal the second core to start drawing the new screen
+    void scr_screen_swap(const bool gamma, const bool dither); // signal the second core to start drawing the new screen; the new scr_screen is not cleared
+    // as scr_screen_swap(), but core1 holds the submit of the frame until present_at, e.g. the present deadline of a
+    // sharded display; a frame that is ready late is submitted at once
+    void scr_screen_swap_at(const bool gamma, const bool dither, const absolute_time_t present_at);
+    // colour correction; the per strip luts are rebuilt once before the next frame
+    void scr_set_brightness(const uint8_t brightness); // master brightness, perceptual (applied before gamma)
+    uint8_t scr_get_brightness();
+    void scr_set_white_point(const int strip, const uint8_t r, const uint8_t g, const uint8_t b); // 255 is full scale; strips out of range are ignored
+
+    // current estimation: each channel draws channel_uA at full intensity, linearly; each led draws idle_uA when dark
+    typedef struct
+    {
+        uint32_t channel_uA[3]; // r, g, b
+        uint32_t idle_uA;
+        uint32_t budget_mA; // 0 disables the current limiter
+    } scr_power_model_t;
+
+    void scr_set_power_model(const scr_power_model_t &model);
+
+#if SCR_INDEXED_MODE
+    void scr_clear_indexed_screen(const uint8_t index = 0);
+    void scr_indexed_screen_swap(const bool gamma); // as scr_screen_swap(), but shows scr_indexed_screen; indexed frames are not dithered
+#endif
+
+#if SCR_DEEP_COLOR
+    void scr_clear_deep_screen();
+    void scr_deep_screen_swap(const bool gamma, const bool dither); // as scr_screen_swap(), but shows scr_deep_screen
+#endif
+
+    // present feedback: frames are numbered by their swap, in any of the modes above
+    typedef struct
+    {
+        uint32_t generation;      // of the last frame the leds latched; static frames are latched again on every refresh
+        absolute_time_t dma_done; // when its data had left the dma
+        absolute_time_t latched;  // when the leds showed it
+        int64_t refresh_us;       // time between two refreshes of core1, smoothed
+        int64_t pipeline_us;      // time from core1 taking a new frame to the leds showing it, smoothed
+    } scr_present_t;
+
+    scr_present_t scr_last_present();
+    uint32_t scr_screen_generation(); // of the last swapped frame; the frame being drawn gets the next one
+    // when the frame being drawn reaches the leds if it is swapped at swap_time
+    absolute_time_t scr_predict_present(const absolute_time_t swap_time);
+    // blocks until core1 starts its next refresh, so that core0 can run its loop in step with it
+    void scr_wait_refresh();
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include <pico/types.h>
+
+#include "blit.hpp"
+#include "screen_layers.hpp"
+
+namespace screen
+{
+    // cached result of all static layers
+    static ws2812::led_color_t __scr_layers_cache[SCREEN_HEIGHT][SCREEN_WIDTH] __attribute__((aligned(4)));
+    static bool __scr_layers_cache_valid = false;
+
+    // background restore issued ahead of compose, see scr_layers_restore_async()
+    static blit::blit_fence_t __scr_layers_restore_fence = 0;
+    static ws2812::led_color_t (*__scr_layers_restored)[SCREEN_HEIGHT][SCREEN_WIDTH] = nullptr;
+
+    static scr_layer_t __scr_layers[SCR_MAX_LAYERS];
+    static int __scr_layers_count = 0;
+    static int __scr_layers_static_count = 0;
+
+    void scr_layers_init(const scr_layer_t *layers, const int n)
+    {
+        hard_assert(n <= SCR_MAX_LAYERS);
+
+        __scr_layers_count = 0;
+        __scr_layers_static_count = 0;
+        for (int i = 0; i < n; i++)
+        {
+            if (layers[i].is_static)
+            {
+                // static layers are flattened into the cache, so nothing dynamic may sit below them
+                hard_assert(i == __scr_layers_static_count);
+                __scr_layers_static_count++;
+            }
+            __scr_layers[__scr_layers_count++] = layers[i];
+        }
+
+        scr_layers_invalidate();
+    }
+
+    void scr_layers_invalidate()
+    {
+        __scr_layers_cache_valid = false;
+    }
+
+    static void __scr_layers_render_cache()
+    {
+        // redirect the primitives to the cache while the static layers are drawn
+        auto screen = scr_screen;
+        scr_screen = &__scr_layers_cache;
+
+        blit::blit_wait(blit::blit_clear(scr_screen));
+        for (int i = 0; i < __scr_layers_static_count; i++)
+        {
+            __scr_layers[i].draw();
+        }
+
+        scr_screen = screen;
+        __scr_layers_cache_valid = true;
+    }
+
+    void scr_layers_restore_async()
+    {
+        if (!__scr_layers_cache_valid)
+        {
+            // compose re-renders the cache first
+            return;
+        }
+        __scr_layers_restore_fence = blit::blit_copy(scr_screen, &__scr_layers_cache, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+        __scr_layers_restored = scr_screen;
+    }
+
+    void scr_layers_compose()
+    {
+        if (!__scr_layers_cache_valid)
+        {
+            // a pending restore of the stale cache must land before it is overwritten
+            blit::blit_wait(__scr_layers_restore_fence);
+            __scr_layers_restored = nullptr;
+            __scr_layers_render_cache();
+        }
+
+        if (__scr_layers_restored != scr_screen)
+        {
+            __scr_layers_restore_fence = blit::blit_copy(scr_screen, &__scr_layers_cache, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+        }
+        blit::blit_wait(__scr_layers_restore_fence);
+        __scr_layers_restored = nullptr;
+
+        for (int i = __scr_layers_static_count; i < __scr_layers_count; i++)
+        {
+            __scr_layers[i].draw();
+        }
+    }
+}
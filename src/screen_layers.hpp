@@ -0,0 +1,24 @@
+#pragma once
+
+#include "screen.hpp"
+
+namespace screen
+{
+    // retained-mode layers, composited bottom to top into scr_screen
+    // static layers are rendered once into a cached background and restored with a single block copy,
+    // dynamic layers are redrawn every frame; all static layers must be below the dynamic ones
+    typedef void (*scr_layer_draw_t)();
+
+    typedef struct
+    {
+        scr_layer_draw_t draw;
+        bool is_static;
+    } scr_layer_t;
+
+    const auto SCR_MAX_LAYERS = 8;
+
+    void scr_layers_init(const scr_layer_t *layers, const int n);
+    void scr_layers_invalidate();    // re-render the static layers on the next compose
+    void scr_layers_compose();       // replaces scr_clear_screen() at the start of a frame
+    void scr_layers_restore_async(); // start restoring the background into scr_screen with dma, ahead of compose
+}
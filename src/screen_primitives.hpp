@@ -1,41 +1,51 @@
 #pragma once
 
-#include <cstdio>
 #include <pico/types.h>
 #include <stdlib.h>
 
+#include "blend.hpp"
 #include "fonts.hpp"
+#include "line.hpp"
+#include "text.hpp"
 #include "screen.hpp"
 #include "ws2812.hpp"
 
+// the primitives taking a frame buffer are templates on its pixel type, like draw_clipped_line() and the
+// text functions: rgb (scr_frame_buffer_t), indexed (palette indices) and deep colour frame buffers share them,
+// with blend_source() and blend_into() adapting the colour to the pixel
 namespace screen
 {
-    static inline void set_pixel(const int x, const int y, const ws2812::led_color_t c)
+    template <typename FRAME_BUFFER, typename COLOR>
+    static inline void set_pixel(FRAME_BUFFER &fb, const int x, const int y, const COLOR c)
     {
         if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT)
         {
-            (*scr_screen)[y][x] = c;
+            fb[y][x] = c;
         }
     }
 
-    static inline void set_pixel(const int x, const int y, const ws2812::led_color_t c, const uint8_t alpha)
+    template <typename BLEND>
+    static inline void blend_pixel(scr_frame_buffer_t &fb, const int x, const int y, const ws2812::led_color_t c, const BLEND &blend)
     {
         if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT)
         {
-            const uint16_t r_scaled = c.r * alpha;
-            const uint16_t g_scaled = c.g * alpha;
-            const uint16_t b_scaled = c.b * alpha;
+            blend_into(fb[y][x], pixel::px_load(c), blend);
+        }
+    }
 
-            const uint8_t anti_alpha = 255 - alpha;
-            volatile ws2812::led_color_t *p = &(*scr_screen)[y][x];
+    static inline void set_pixel(scr_frame_buffer_t &fb, const int x, const int y, const ws2812::led_color_t c, const uint8_t alpha)
+    {
+        blend_pixel(fb, x, y, c, blend_alpha(alpha));
+    }
 
-            p->g = (p->g * anti_alpha + g_scaled) >> 8;
-            p->r = (p->r * anti_alpha + r_scaled) >> 8;
-            p->b = (p->b * anti_alpha + b_scaled) >> 8;
-        }
+    // additive blending, saturating each channel at 255; used for light effects such as particles
+    static inline void add_pixel(scr_frame_buffer_t &fb, const int x, const int y, const ws2812::led_color_t c)
+    {
+        blend_pixel(fb, x, y, c, blend_add());
     }
 
-    static inline void draw_vertical_line(const int x, int y0, int y1, const ws2812::led_color_t c)
+    template <typename FRAME_BUFFER, typename COLOR, typename BLEND = blend_replace>
+    static inline void draw_vertical_line(FRAME_BUFFER &fb, const int x, int y0, int y1, const COLOR c, const BLEND &blend = BLEND())
     {
         if (x < 0 || x >= SCREEN_WIDTH)
         {
@@ -59,13 +69,15 @@ namespace screen
         {
             y1 = SCREEN_HEIGHT - 1;
         }
+        const auto src = blend_source(c);
         for (int y = y0; y <= y1; y++)
         {
-            (*scr_screen)[y][x] = c;
+            blend_into(fb[y][x], src, blend);
         }
     }
 
-    static inline void draw_horizontal_line(const int y, int x0, int x1, const ws2812::led_color_t c)
+    template <typename FRAME_BUFFER, typename COLOR, typename BLEND = blend_replace>
+    static inline void draw_horizontal_line(FRAME_BUFFER &fb, const int y, int x0, int x1, const COLOR c, const BLEND &blend = BLEND())
     {
         if (y < 0 || y >= SCREEN_HEIGHT)
         {
@@ -89,109 +101,29 @@ namespace screen
         {
             x1 = SCREEN_WIDTH - 1;
         }
+        const auto src = blend_source(c);
         for (int x = x0; x <= x1; x++)
         {
-            (*scr_screen)[y][x] = c;
+            blend_into(fb[y][x], src, blend);
         }
     }
 
-    static inline void draw_line(int x0, int y0, int x1, int y1, const ws2812::led_color_t c)
+    template <typename FRAME_BUFFER, typename COLOR>
+    static inline void draw_line(FRAME_BUFFER &fb, int x0, int y0, int x1, int y1, const COLOR c)
     {
         if (x0 == x1)
         {
-            draw_vertical_line(x0, y0, y1, c);
+            draw_vertical_line(fb, x0, y0, y1, c);
             return;
         }
 
         if (y0 == y1)
         {
-            draw_horizontal_line(y0, x0, x1, c);
+            draw_horizontal_line(fb, y0, x0, x1, c);
             return;
         }
 
-        // exit if the line is not visible
-        if ((x0 < 0 && x1 < 0) ||
-            (y0 < 0 && y1 < 0) ||
-            (x0 >= SCREEN_WIDTH && x1 >= SCREEN_WIDTH) ||
-            (y0 >= SCREEN_HEIGHT && y1 >= SCREEN_HEIGHT))
-        {
-            return;
-        }
-
-        // swap x coordinates if needed
-        if (x0 > x1)
-        {
-            int tmp = x0;
-            x0 = x1;
-            x1 = tmp;
-            tmp = y0;
-            y0 = y1;
-            y1 = tmp;
-        }
-
-        // clip the line to the screen
-        if (x0 < 0)
-        {
-            y0 += (0.0 - x0) * (y1 - y0) / (x1 - x0);
-            x0 = 0;
-        }
-        if (x1 >= SCREEN_WIDTH)
-        {
-            y1 -= (x1 - SCREEN_WIDTH + 1.0) * (y1 - y0) / (x1 - x0);
-            x1 = SCREEN_WIDTH - 1;
-        }
-
-        // swap y coordinates if needed
-        if (y0 > y1)
-        {
-            int tmp = y0;
-            y0 = y1;
-            y1 = tmp;
-            tmp = x0;
-            x0 = x1;
-            x1 = tmp;
-        }
-
-        // clip the line to the screen
-        if (y0 < 0)
-        {
-            x0 += (0.0 - y0) * (x1 - x0) / (y1 - y0);
-            y0 = 0;
-        }
-        if (y1 >= SCREEN_HEIGHT)
-        {
-            x1 -= (y1 - SCREEN_HEIGHT + 1.0) * (x1 - x0) / (y1 - y0);
-            y1 = SCREEN_HEIGHT - 1;
-        }
-
-        // naive Bresenham's line algorithm
-        const int dx = abs(x1 - x0);
-        const int dy = abs(y1 - y0);
-        const int sx = x0 < x1 ? 1 : -1;
-        const int sy = y0 < y1 ? 1 : -1;
-        int err = dx - dy;
-
-        while (true)
-        {
-            set_pixel(x0, y0, c);
-            if (x0 == x1 && y0 == y1)
-            {
-                break;
-            }
-            const int e2 = 2 * err;
-            if (e2 > -dy)
-            {
-                err -= dy;
-                x0 += sx;
-            }
-            if (e2 < dx)
-            {
-                err += dx;
-                y0 += sy;
-            }
-        }
-
-        return;
+        draw_clipped_line(fb, x0, y0, x1, y1, c);
     }
 
 #define FIX_RECT_COORDS(x, y, w, h, screen_width, screen_height) \
@@ -218,136 +150,82 @@ namespace screen
         return;                                                  \
     }
 
-    static inline void draw_rect(int x, int y, int w, int h, const ws2812::led_color_t c)
+    template <typename FRAME_BUFFER, typename COLOR, typename BLEND = blend_replace>
+    static inline void draw_rect(FRAME_BUFFER &fb, int x, int y, int w, int h, const COLOR c, const BLEND &blend = BLEND())
     {
         // fix coordinates to be within the screen
         FIX_RECT_COORDS(x, y, w, h, SCREEN_WIDTH, SCREEN_HEIGHT)
 
+        const auto src = blend_source(c);
         for (int i = y; i < y + h; i++)
         {
             for (int j = x; j < x + w; j++)
             {
-                (*scr_screen)[i][j] = c;
+                blend_into(fb[i][j], src, blend);
             }
         }
     }
 
-    static inline void draw_transparent_rect(int x, int y, int w, int h, const ws2812::led_color_t c, const uint8_t alpha)
+    static inline void draw_transparent_rect(scr_frame_buffer_t &fb, int x, int y, int w, int h, const ws2812::led_color_t c, const uint8_t alpha)
     {
-        // fix coordinates to be within the screen
-        FIX_RECT_COORDS(x, y, w, h, SCREEN_WIDTH, SCREEN_HEIGHT)
-
-        const uint16_t r_scaled = c.r * alpha;
-        const uint16_t g_scaled = c.g * alpha;
-        const uint16_t b_scaled = c.b * alpha;
-
-        for (int i = 0; i < h; i++)
-        {
-            const uint8_t anti_alpha = 255 - alpha;
-            volatile ws2812::led_color_t *p = &(*scr_screen)[y + i][x];
-
-            for (int j = 0; j < w; j++)
-            {
-                p->g = (p->g * anti_alpha + g_scaled) >> 8;
-                p->r = (p->r * anti_alpha + r_scaled) >> 8;
-                p->b = (p->b * anti_alpha + b_scaled) >> 8;
-                p++;
-            }
-        }
+        draw_rect(fb, x, y, w, h, c, blend_alpha(alpha));
     }
 
     // draw a 3x5 char at the specified position
     // x and y are considered to be the top left corner of the character
-    void draw_3x5_char(const char ch, const int x, int y, const ws2812::led_color_t c)
+    template <typename FRAME_BUFFER, typename COLOR>
+    inline void draw_3x5_char(FRAME_BUFFER &fb, const char ch, const int x, int y, const COLOR c)
     {
-        const uint8_t *font_char = font_3x5_missing_char;
-        int font_char_column = 0;
-
-        if (ch >= 32 && ch <= 96)
-        {
-            font_char_column = ch - 32;
-            font_char = font_3x5_32_96_optimized[font_char_column / 2];
-        }
-        else
-        {
-            if (ch >= 'a' && ch <= 'z') // a-z
-            {
-                font_char_column = ch - 'a' + 'A' - 32;
-                font_char = font_3x5_32_96_optimized[font_char_column / 2];
-            }
-            else
-            {
-                if (ch >= 123 && ch <= 126)
-                {
-                    font_char_column = ch - 122;
-                    font_char = font_3x5_122_126_optimized[font_char_column / 2];
-                }
-            }
-        }
+        draw_3x5_glyph(fb, font_3x5_glyph(ch), x, y, c);
+    }
 
-        for (int row = 0; row < 5; row++, y++)
+    template <typename FRAME_BUFFER, typename COLOR>
+    inline void draw_3x5_string(FRAME_BUFFER &fb, const char *str, const int x, const int y, const COLOR c, const font_3x5_alignment_t alignment = FONT_3X5_LEFT)
+    {
+        if (alignment == FONT_3X5_LEFT)
         {
-            const uint8_t line = (font_char_column % 2) ? font_char[row] : (font_char[row] >> 3);
-
-            if (line & 0b100)
-            {
-                set_pixel(x, y, c);
-            }
-            if (line & 0b010)
+            // no need to measure the string first
+            for (int left = x; *str; str++, left += FONT_3X5_ADVANCE)
             {
-                set_pixel(x + 1, y, c);
-            }
-            if (line & 0b001)
-            {
-                set_pixel(x + 2, y, c);
+                draw_3x5_glyph(fb, font_3x5_glyph(*str), left, y, c);
             }
+            return;
         }
+        draw_3x5_text(fb, text_3x5(str), x, y, c, alignment);
     }
 
-    enum font_3x5_alignment_t
+    template <typename FRAME_BUFFER, typename COLOR>
+    inline void draw_3x5_number(FRAME_BUFFER &fb, const uint number, const int x, const int y, const COLOR c, const font_3x5_alignment_t alignment = FONT_3X5_LEFT)
     {
-        FONT_3X5_CENTER = 0,
-        FONT_3X5_LEFT = 1,
-        FONT_3X5_RIGHT = 2
-    };
+        draw_3x5_unsigned(fb, number, x, y, c, alignment);
+    }
 
-    void draw_3x5_string(const char *str, const int x, const int y, const ws2812::led_color_t c, const font_3x5_alignment_t alignment = FONT_3X5_LEFT)
+    // deep colour, left to right from c0 to c1; the steps between neighbouring columns can be far below one 8-bit level
+    static inline void draw_horizontal_gradient(scr_deep_frame_buffer_t &fb, const int x, const int y, const int w, const int h, const scr_deep_color_t c0, const scr_deep_color_t c1)
     {
-        switch (alignment)
+        for (int i = 0; i < w; i++)
         {
-        case FONT_3X5_CENTER:
-            draw_3x5_string(str, x - strlen(str) * 4 / 2, y, c, FONT_3X5_LEFT);
-            break;
-
-        case FONT_3X5_RIGHT:
-            draw_3x5_string(str, x - strlen(str) * 4 + 1, y, c, FONT_3X5_LEFT);
-            break;
-
-        default:
-            for (int i = 0; str[i] != '\0'; i++)
-            {
-                draw_3x5_char(str[i], x + i * 4, y, c);
-            }
-            break;
+            const int32_t t = w > 1 ? i * 65536 / (w - 1) : 0;
+            const scr_deep_color_t c = {
+                (uint16_t)(c0.r + (((int64_t)c1.r - c0.r) * t >> 16)),
+                (uint16_t)(c0.g + (((int64_t)c1.g - c0.g) * t >> 16)),
+                (uint16_t)(c0.b + (((int64_t)c1.b - c0.b) * t >> 16))};
+            draw_rect(fb, x + i, y, 1, h, c);
         }
     }
 
-    void draw_3x5_number(const uint number, const int x, const int y, const ws2812::led_color_t c, const font_3x5_alignment_t alignment = FONT_3X5_LEFT)
-    {
-        char buffer[16];
-        snprintf(buffer, sizeof(buffer), "%u", number);
-        draw_3x5_string(buffer, x, y, c, alignment);
-    }
-
-    void draw_orb(const float x_c, const float y_c, const float radius, const ws2812::led_color_t c)
+    // the orb's coverage fades between the frame buffer and the blended colour
+    template <typename BLEND = blend_replace>
+    inline void draw_orb(scr_frame_buffer_t &fb, const float x_c, const float y_c, const float radius, const ws2812::led_color_t c, const BLEND &blend = BLEND())
     {
         if (x_c + radius < 0 || x_c - radius >= SCREEN_WIDTH || y_c + radius < 0 || y_c - radius >= SCREEN_HEIGHT)
         {
             return;
         }
+        const pixel::px_t src = pixel::px_load(c);
         if (radius <= 0)
         {
-            (*scr_screen)[(int)y_c][(int)x_c] = c;
+            blend_into(fb[(int)y_c][(int)x_c], src, blend);
         }
 
         for (int x = x_c - radius; x <= x_c + radius + 1; x++)
@@ -355,11 +233,88 @@ namespace screen
             for (int y = y_c - radius; y <= y_c + radius + 1; y++)
             {
                 const float d = ((x - x_c) * (x - x_c) + (y - y_c) * (y - y_c)) / (radius * radius);
-                if (d <= 1)
+                if (d <= 1 && x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT)
                 {
-                    set_pixel(x, y, c, (1 - d) * 255);
+                    blend_into(fb[y][x], src, blend, (uint32_t)((1 - d) * 256));
                 }
             }
         }
     }
-}
\ No newline at end of file
+
+    // the primitives below draw into scr_screen, the frame buffer core0 is currently drawing
+    static inline void set_pixel(const int x, const int y, const ws2812::led_color_t c)
+    {
+        set_pixel(*scr_screen, x, y, c);
+    }
+
+    static inline void set_pixel(const int x, const int y, const ws2812::led_color_t c, const uint8_t alpha)
+    {
+        set_pixel(*scr_screen, x, y, c, alpha);
+    }
+
+    static inline void add_pixel(const int x, const int y, const ws2812::led_color_t c)
+    {
+        add_pixel(*scr_screen, x, y, c);
+    }
+
+    template <typename BLEND = blend_replace>
+    static inline void draw_vertical_line(const int x, int y0, int y1, const ws2812::led_color_t c, const BLEND &blend = BLEND())
+    {
+        draw_vertical_line(*scr_screen, x, y0, y1, c, blend);
+    }
+
+    template <typename BLEND = blend_replace>
+    static inline void draw_horizontal_line(const int y, int x0, int x1, const ws2812::led_color_t c, const BLEND &blend = BLEND())
+    {
+        draw_horizontal_line(*scr_screen, y, x0, x1, c, blend);
+    }
+
+    static inline void draw_line(int x0, int y0, int x1, int y1, const ws2812::led_color_t c)
+    {
+        draw_line(*scr_screen, x0, y0, x1, y1, c);
+    }
+
+    template <typename BLEND = blend_replace>
+    static inline void draw_line_aa(int x0, int y0, int x1, int y1, const ws2812::led_color_t c, const BLEND &blend = BLEND())
+    {
+        draw_line_aa(*scr_screen, x0, y0, x1, y1, c, blend);
+    }
+
+    template <typename BLEND = blend_replace>
+    static inline void draw_rect(int x, int y, int w, int h, const ws2812::led_color_t c, const BLEND &blend = BLEND())
+    {
+        draw_rect(*scr_screen, x, y, w, h, c, blend);
+    }
+
+    static inline void draw_transparent_rect(int x, int y, int w, int h, const ws2812::led_color_t c, const uint8_t alpha)
+    {
+        draw_transparent_rect(*scr_screen, x, y, w, h, c, alpha);
+    }
+
+    inline void draw_3x5_char(const char ch, const int x, int y, const ws2812::led_color_t c)
+    {
+        draw_3x5_char(*scr_screen, ch, x, y, c);
+    }
+
+    inline void draw_3x5_string(const char *str, const int x, const int y, const ws2812::led_color_t c, const font_3x5_alignment_t alignment = FONT_3X5_LEFT)
+    {
+        draw_3x5_string(*scr_screen, str, x, y, c, alignment);
+    }
+
+    template <typename BLEND = blend_replace>
+    inline void draw_3x5_text(const text_3x5_t &text, const int x, const int y, const ws2812::led_color_t c, const font_3x5_alignment_t alignment = FONT_3X5_LEFT, const BLEND &blend = BLEND())
+    {
+        draw_3x5_text(*scr_screen, text, x, y, c, alignment, blend);
+    }
+
+    inline void draw_3x5_number(const uint number, const int x, const int y, const ws2812::led_color_t c, const font_3x5_alignment_t alignment = FONT_3X5_LEFT)
+    {
+        draw_3x5_number(*scr_screen, number, x, y, c, alignment);
+    }
+
+    template <typename BLEND = blend_replace>
+    inline void draw_orb(const float x_c, const float y_c, const float radius, const ws2812::led_color_t c, const BLEND &blend = BLEND())
+    {
+        draw_orb(*scr_screen, x_c, y_c, radius, c, blend);
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <pico/platform.h>
+#include <stdint.h>
+
+// a record with one writer (a core, or an irq on it) and readers on either core: seq is odd while the record is
+// written, so a reader that overlapped a write copies it again instead of returning half of it
+// the writer may read value directly
+namespace seqlock
+{
+    template <typename T>
+    struct seqlock_t
+    {
+        T value;
+        std::atomic<uint32_t> seq;
+    };
+
+    template <typename T, typename WRITE>
+    static inline void seqlock_write(seqlock_t<T> &lock, WRITE write)
+    {
+        lock.seq.fetch_add(1);
+        write(lock.value);
+        lock.seq.fetch_add(1);
+    }
+
+    template <typename T>
+    static inline T seqlock_read(const seqlock_t<T> &lock)
+    {
+        T value;
+        uint32_t seq;
+        do
+        {
+            seq = lock.seq.load();
+            value = lock.value;
+        } while ((seq & 1) || seq != lock.seq.load());
+        return value;
+    }
+
+    // returns once the write in progress, or else the next one, is complete
+    template <typename T>
+    static inline void seqlock_wait_write(const seqlock_t<T> &lock)
+    {
+        const uint32_t seq = lock.seq.load() | 1;
+        while ((lock.seq.load() | 1) == seq)
+        {
+            tight_loop_contents();
+        }
+    }
+}
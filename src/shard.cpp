@@ -0,0 +1,497 @@
+#include <string.h>
+
+#include "shard.hpp"
+
+#ifndef HOST_BUILD
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <hardware/uart.h>
+#endif
+
+namespace shard
+{
+    static uint16_t __fletcher16(const uint8_t *data, const size_t length)
+    {
+        uint32_t a = 0, b = 0;
+        for (size_t i = 0; i < length; i++)
+        {
+            a = (a + data[i]) % 255;
+            b = (b + a) % 255;
+        }
+        return (uint16_t)((b << 8) | a);
+    }
+
+    static size_t __seal_packet(uint8_t *packet, const uint8_t type, const uint8_t id, const uint8_t seq, const size_t payload_length)
+    {
+        packet[0] = SHARD_MAGIC;
+        packet[1] = type;
+        packet[2] = id;
+        packet[3] = seq;
+        packet[4] = payload_length & 0xff;
+        packet[5] = payload_length >> 8;
+        const uint16_t checksum = __fletcher16(packet + 1, SHARD_HEADER_BYTES - 1 + payload_length);
+        packet[SHARD_HEADER_BYTES + payload_length] = checksum & 0xff;
+        packet[SHARD_HEADER_BYTES + payload_length + 1] = checksum >> 8;
+        return SHARD_HEADER_BYTES + payload_length + SHARD_CHECKSUM_BYTES;
+    }
+
+    static inline bool __same_color(const ws2812::led_color_t a, const ws2812::led_color_t b)
+    {
+        return a.r == b.r && a.g == b.g && a.b == b.b;
+    }
+
+    static inline uint8_t *__put_rgb(uint8_t *p, const ws2812::led_color_t c)
+    {
+        p[0] = c.r;
+        p[1] = c.g;
+        p[2] = c.b;
+        return p + 3;
+    }
+
+    void shard_encoder_init(shard_encoder_t &encoder, const uint8_t id, const shard_region_t &region)
+    {
+        encoder.id = id;
+        encoder.region = region;
+        encoder.frames_since_key = SHARD_KEY_INTERVAL; // the first frame is a key frame
+        memset(encoder.previous, 0, sizeof(encoder.previous));
+    }
+
+    size_t shard_encode(shard_encoder_t &encoder, const uint8_t seq, const ws2812::led_color_t *frame, const int stride, uint8_t *packet)
+    {
+        const shard_region_t &region = encoder.region;
+        const int n = region.width * region.height;
+        const size_t key_length = 2 + 3 * n;
+        uint8_t *const payload = packet + SHARD_HEADER_BYTES;
+        payload[0] = region.width;
+        payload[1] = region.height;
+
+        if (encoder.frames_since_key < SHARD_KEY_INTERVAL)
+        {
+            // runs of (skip, count, pixels); given up as soon as it could grow as large as a key frame
+            uint8_t *p = payload + 2;
+            uint8_t *run = nullptr; // count of the open run
+            int skip = 0;
+            bool smaller = true;
+            for (int y = 0, i = 0; y < region.height && smaller; y++)
+            {
+                const ws2812::led_color_t *row = frame + (region.y0 + y) * stride + region.x0;
+                for (int x = 0; x < region.width; x++, i++)
+                {
+                    if (__same_color(row[x], encoder.previous[i]))
+                    {
+                        skip++;
+                        run = nullptr;
+                        continue;
+                    }
+                    if ((size_t)(p - payload) + 2 * (skip / 255) + 5 >= key_length)
+                    {
+                        smaller = false;
+                        break;
+                    }
+                    if (run == nullptr || *run == 255)
+                    {
+                        for (; skip > 255; skip -= 255)
+                        {
+                            *p++ = 255;
+                            *p++ = 0;
+                        }
+                        *p++ = skip;
+                        run = p;
+                        *p++ = 0;
+                        skip = 0;
+                    }
+                    (*run)++;
+                    p = __put_rgb(p, row[x]);
+                }
+            }
+            if (smaller)
+            {
+                for (int y = 0; y < region.height; y++)
+                {
+                    memcpy(encoder.previous + y * region.width, frame + (region.y0 + y) * stride + region.x0, region.width * sizeof(ws2812::led_color_t));
+                }
+                encoder.frames_since_key++;
+                return __seal_packet(packet, SHARD_PACKET_DELTA, encoder.id, seq, p - payload);
+            }
+        }
+
+        uint8_t *p = payload + 2;
+        for (int y = 0; y < region.height; y++)
+        {
+            const ws2812::led_color_t *row = frame + (region.y0 + y) * stride + region.x0;
+            memcpy(encoder.previous + y * region.width, row, region.width * sizeof(ws2812::led_color_t));
+            for (int x = 0; x < region.width; x++)
+            {
+                p = __put_rgb(p, row[x]);
+            }
+        }
+        encoder.frames_since_key = 0;
+        return __seal_packet(packet, SHARD_PACKET_KEY, encoder.id, seq, key_length);
+    }
+
+    size_t shard_encode_present(const uint8_t seq, const uint32_t delay_us, uint8_t *packet)
+    {
+        uint8_t *const payload = packet + SHARD_HEADER_BYTES;
+        for (int i = 0; i < SHARD_PRESENT_PAYLOAD; i++)
+        {
+            payload[i] = (delay_us >> (8 * i)) & 0xff;
+        }
+        return __seal_packet(packet, SHARD_PACKET_PRESENT, SHARD_BROADCAST, seq, SHARD_PRESENT_PAYLOAD);
+    }
+
+    size_t shard_encode_frame(shard_encoder_t *encoders, const int count, const uint8_t seq, const uint32_t delay_us, const ws2812::led_color_t *frame, const int stride, uint8_t *packets)
+    {
+        size_t length = 0;
+        for (int i = 0; i < count; i++)
+        {
+            length += shard_encode(encoders[i], seq, frame, stride, packets + length);
+        }
+        return length + shard_encode_present(seq, delay_us, packets + length);
+    }
+
+    absolute_time_t shard_present_deadline(const shard_link_t &link, const absolute_time_t written, const size_t length, const uint32_t delay_us)
+    {
+        const uint64_t wire_us = ((uint64_t)length * link.byte_ns + 999) / 1000;
+        return delayed_by_us(written, wire_us + delay_us);
+    }
+
+    void shard_decoder_init(shard_decoder_t &decoder, const uint8_t id)
+    {
+        decoder.id = id;
+        decoder.in_sync = false;
+        decoder.seq = 0;
+        decoder.received = 0;
+        decoder.expected = 0;
+        decoder.packets_dropped = 0;
+        decoder.present_at = get_absolute_time();
+        memset(decoder.frame, 0, sizeof(decoder.frame));
+    }
+
+    static inline void __put_pixel(shard_decoder_t &decoder, const int i, const int width, const uint8_t *rgb)
+    {
+        const int x = i % width;
+        const int y = i / width;
+        if (x < screen::PANEL_WIDTH && y < screen::PANEL_HEIGHT)
+        {
+            decoder.frame[y][x] = ws2812_pack_color(rgb[0], rgb[1], rgb[2]);
+        }
+    }
+
+    static bool __apply_region(shard_decoder_t &decoder, const uint8_t type, const uint8_t *payload, const size_t length)
+    {
+        if (length < 2 || payload[0] == 0)
+        {
+            return false;
+        }
+        const int width = payload[0];
+        const int n = width * payload[1];
+        const uint8_t *p = payload + 2;
+        const uint8_t *const end = payload + length;
+
+        if (type == SHARD_PACKET_KEY)
+        {
+            if (length != (size_t)(2 + 3 * n))
+            {
+                return false;
+            }
+            for (int i = 0; i < n; i++, p += 3)
+            {
+                __put_pixel(decoder, i, width, p);
+            }
+            return true;
+        }
+
+        int i = 0;
+        while (end - p >= 2)
+        {
+            i += p[0];
+            const int count = p[1];
+            p += 2;
+            if (end - p < 3 * count || i + count > n)
+            {
+                return false;
+            }
+            for (int c = 0; c < count; c++, i++, p += 3)
+            {
+                __put_pixel(decoder, i, width, p);
+            }
+        }
+        return p == end;
+    }
+
+    shard_event_t shard_decoder_push(shard_decoder_t &decoder, const uint8_t byte)
+    {
+        // hunt for the start of a packet
+        if (decoder.received == 0 && byte != SHARD_MAGIC)
+        {
+            return SHARD_EVENT_NONE;
+        }
+        uint8_t *const packet = decoder.packet;
+        packet[decoder.received++] = byte;
+        if (decoder.received == SHARD_HEADER_BYTES)
+        {
+            const size_t length = packet[4] | (packet[5] << 8);
+            if (length > SHARD_MAX_PAYLOAD)
+            {
+                decoder.received = 0;
+                decoder.packets_dropped++;
+                return SHARD_EVENT_NONE;
+            }
+            decoder.expected = SHARD_HEADER_BYTES + length + SHARD_CHECKSUM_BYTES;
+        }
+        if (decoder.received < SHARD_HEADER_BYTES || decoder.received < decoder.expected)
+        {
+            return SHARD_EVENT_NONE;
+        }
+        decoder.received = 0;
+
+        const size_t length = decoder.expected - SHARD_HEADER_BYTES - SHARD_CHECKSUM_BYTES;
+        const uint16_t checksum = packet[SHARD_HEADER_BYTES + length] | (packet[SHARD_HEADER_BYTES + length + 1] << 8);
+        if (checksum != __fletcher16(packet + 1, SHARD_HEADER_BYTES - 1 + length))
+        {
+            decoder.packets_dropped++;
+            return SHARD_EVENT_NONE;
+        }
+
+        const uint8_t type = packet[1];
+        const uint8_t id = packet[2];
+        const uint8_t seq = packet[3];
+        if (type == SHARD_PACKET_PRESENT)
+        {
+            // a follower that missed part of the frame keeps showing the previous one
+            if (length != SHARD_PRESENT_PAYLOAD || !decoder.in_sync || seq != decoder.seq)
+            {
+                return SHARD_EVENT_NONE;
+            }
+            // the delay counts from the end of the packet, which is now
+            const uint8_t *const payload = packet + SHARD_HEADER_BYTES;
+            const uint32_t delay_us = payload[0] | (payload[1] << 8) | (payload[2] << 16) | ((uint32_t)payload[3] << 24);
+            decoder.present_at = delayed_by_us(get_absolute_time(), delay_us);
+            return SHARD_EVENT_PRESENT;
+        }
+        if (id != decoder.id)
+        {
+            return SHARD_EVENT_NONE;
+        }
+        if (type == SHARD_PACKET_DELTA && (!decoder.in_sync || seq != (uint8_t)(decoder.seq + 1)))
+        {
+            // deltas only apply on top of the previous frame; wait for the next key frame
+            decoder.in_sync = false;
+            decoder.packets_dropped++;
+            return SHARD_EVENT_NONE;
+        }
+        if ((type != SHARD_PACKET_KEY && type != SHARD_PACKET_DELTA) || !__apply_region(decoder, type, packet + SHARD_HEADER_BYTES, length))
+        {
+            decoder.in_sync = false;
+            decoder.packets_dropped++;
+            return SHARD_EVENT_NONE;
+        }
+        decoder.in_sync = true;
+        decoder.seq = seq;
+        return SHARD_EVENT_REGION;
+    }
+
+#if SHARD_ROLE == SHARD_ROLE_MASTER
+    static constexpr shard_region_t __shard_regions[SHARD_COUNT] = SHARD_REGIONS;
+
+    constexpr bool __shard_regions_valid()
+    {
+        for (int i = 0; i < SHARD_COUNT; i++)
+        {
+            const shard_region_t &region = __shard_regions[i];
+            if (region.x0 < 0 || region.y0 < 0 || region.width <= 0 || region.height <= 0 ||
+                region.x0 + region.width > screen::SCREEN_WIDTH || region.y0 + region.height > screen::SCREEN_HEIGHT ||
+                region.width > screen::PANEL_WIDTH || region.height > screen::PANEL_HEIGHT)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    static_assert(__shard_regions_valid(), "SHARD_REGIONS must be on the canvas and fit the leds of a follower");
+
+    static shard_encoder_t __shard_encoders[SHARD_COUNT];
+    static uint8_t __shard_frame[SHARD_MAX_FRAME]; // staged for the link, which sends it from here
+    static shard_link_t __shard_link = {};
+    static uint8_t __shard_seq = 0;
+    static uint32_t __shard_bytes_sent = 0;
+
+    void shard_master_init(const shard_link_t &link)
+    {
+        for (int i = 0; i < SHARD_COUNT; i++)
+        {
+            shard_encoder_init(__shard_encoders[i], i, __shard_regions[i]);
+        }
+        __shard_link = link;
+    }
+
+    bool shard_master_send_frame(const ws2812::led_color_t *frame, const int stride, absolute_time_t &present_at)
+    {
+        // nothing before shard_master_init(), and the staging buffer stays untouched until the link has sent it
+        if (!__shard_link.write || __shard_link.busy())
+        {
+            return false;
+        }
+        __shard_seq++;
+        const size_t length = shard_encode_frame(__shard_encoders, SHARD_COUNT, __shard_seq, SHARD_PRESENT_DELAY_US, frame, stride, __shard_frame);
+        const absolute_time_t written = get_absolute_time();
+        __shard_link.write(__shard_frame, length);
+        __shard_bytes_sent += length;
+        present_at = shard_present_deadline(__shard_link, written, length, SHARD_PRESENT_DELAY_US);
+        return true;
+    }
+
+    uint32_t shard_master_bytes_sent()
+    {
+        return __shard_bytes_sent;
+    }
+#endif
+
+#if SHARD_ROLE == SHARD_ROLE_FOLLOWER
+    static_assert(screen::SCREEN_WIDTH == screen::PANEL_WIDTH && screen::SCREEN_HEIGHT == screen::PANEL_HEIGHT,
+                  "followers show their shard on a canvas of their own leds");
+
+    static shard_decoder_t __shard_decoder;
+    static shard_link_t __shard_link;
+
+    void shard_follower_init(const shard_link_t &link)
+    {
+        __shard_link = link;
+        shard_decoder_init(__shard_decoder, SHARD_ID);
+    }
+
+    bool shard_follower_poll(absolute_time_t &present_at)
+    {
+        // byte by byte, so that the bytes after a present stay in the link for the next call
+        uint8_t byte;
+        while (__shard_link.read(&byte, 1))
+        {
+            if (shard_decoder_push(__shard_decoder, byte) == SHARD_EVENT_PRESENT)
+            {
+                present_at = __shard_decoder.present_at;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const ws2812::led_color_t (*shard_follower_frame())[screen::PANEL_WIDTH]
+    {
+        return __shard_decoder.frame;
+    }
+#endif
+
+#ifdef HOST_BUILD
+    static uint8_t __loopback[1 << 16];
+    static size_t __loopback_head = 0;
+    static size_t __loopback_tail = 0;
+    // the bytes of the last write arrive one by one after it; the earlier ones are all in
+    static uint32_t __loopback_byte_ns = 0;
+    static size_t __loopback_write_head = 0;
+    static absolute_time_t __loopback_write_time;
+
+    // when byte i of the last write has gone over the wire
+    static absolute_time_t __loopback_arrival(const size_t i)
+    {
+        return delayed_by_us(__loopback_write_time, ((uint64_t)(i + 1) * __loopback_byte_ns + 999) / 1000);
+    }
+
+    static void __loopback_write(const uint8_t *data, const size_t length)
+    {
+        __loopback_write_head = __loopback_head;
+        __loopback_write_time = get_absolute_time();
+        for (size_t i = 0; i < length; i++)
+        {
+            __loopback[__loopback_head++ % sizeof(__loopback)] = data[i];
+        }
+    }
+
+    static bool __loopback_busy()
+    {
+        return __loopback_head != __loopback_write_head &&
+               absolute_time_diff_us(get_absolute_time(), __loopback_arrival(__loopback_head - __loopback_write_head - 1)) > 0;
+    }
+
+    static size_t __loopback_read(uint8_t *data, const size_t max_length)
+    {
+        const absolute_time_t now = get_absolute_time();
+        size_t n = 0;
+        while (n < max_length && __loopback_tail != __loopback_head &&
+               (__loopback_tail < __loopback_write_head || absolute_time_diff_us(now, __loopback_arrival(__loopback_tail - __loopback_write_head)) <= 0))
+        {
+            data[n++] = __loopback[__loopback_tail++ % sizeof(__loopback)];
+        }
+        return n;
+    }
+
+    shard_link_t shard_link_loopback(const uint32_t byte_ns)
+    {
+        __loopback_head = __loopback_tail = __loopback_write_head = 0;
+        __loopback_byte_ns = byte_ns;
+        __loopback_write_time = get_absolute_time();
+        return {__loopback_write, __loopback_busy, __loopback_read, byte_ns};
+    }
+#else
+    // the tx side is fed by dma straight from the caller's buffer, so core1 does not wait for the wire;
+    // the rx side runs into a dma ring, so nothing is lost while the follower waits for its screen swap
+    static const auto SHARD_RX_RING_BITS = 14;
+    static uint8_t __shard_rx_ring[1 << SHARD_RX_RING_BITS] __attribute__((aligned(1 << SHARD_RX_RING_BITS)));
+    static int __shard_rx_dma_channel;
+    static int __shard_tx_dma_channel;
+    static size_t __shard_rx_tail = 0;
+
+    static void __uart_write(const uint8_t *data, const size_t length)
+    {
+        dma_channel_transfer_from_buffer_now(__shard_tx_dma_channel, data, length);
+    }
+
+    static bool __uart_busy()
+    {
+        return dma_channel_is_busy(__shard_tx_dma_channel);
+    }
+
+    static size_t __uart_read(uint8_t *data, const size_t max_length)
+    {
+        const size_t head = dma_channel_hw_addr(__shard_rx_dma_channel)->write_addr - (uintptr_t)__shard_rx_ring;
+        size_t n = 0;
+        while (n < max_length && __shard_rx_tail != head)
+        {
+            data[n++] = __shard_rx_ring[__shard_rx_tail];
+            __shard_rx_tail = (__shard_rx_tail + 1) & (sizeof(__shard_rx_ring) - 1);
+        }
+        return n;
+    }
+
+    shard_link_t shard_link_uart()
+    {
+        const uint baud = uart_init(uart1, SHARD_UART_BAUD);
+        gpio_set_function(SHARD_UART_TX_PIN, GPIO_FUNC_UART);
+        gpio_set_function(SHARD_UART_RX_PIN, GPIO_FUNC_UART);
+
+        __shard_tx_dma_channel = dma_claim_unused_channel(true);
+        dma_channel_config tx_config = dma_channel_get_default_config(__shard_tx_dma_channel);
+        channel_config_set_transfer_data_size(&tx_config, DMA_SIZE_8);
+        channel_config_set_dreq(&tx_config, uart_get_dreq(uart1, true));
+        channel_config_set_read_increment(&tx_config, true);
+        channel_config_set_write_increment(&tx_config, false);
+        dma_channel_configure(__shard_tx_dma_channel, &tx_config, &uart_get_hw(uart1)->dr, NULL, 0, false);
+
+        __shard_rx_dma_channel = dma_claim_unused_channel(true);
+        dma_channel_config channel_config = dma_channel_get_default_config(__shard_rx_dma_channel);
+        channel_config_set_transfer_data_size(&channel_config, DMA_SIZE_8);
+        channel_config_set_dreq(&channel_config, uart_get_dreq(uart1, false));
+        channel_config_set_read_increment(&channel_config, false);
+        channel_config_set_write_increment(&channel_config, true);
+        channel_config_set_ring(&channel_config, true, SHARD_RX_RING_BITS);
+        dma_channel_configure(
+            __shard_rx_dma_channel,
+            &channel_config,
+            __shard_rx_ring,
+            &uart_get_hw(uart1)->dr,
+            0xffffffff, // endless on the rp2350
+            true);
+
+        return {__uart_write, __uart_busy, __uart_read, (uint32_t)(10000000000ull / baud)}; // 8n1: 10 bits a byte
+    }
+#endif
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <pico/time.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "screen.hpp"
+
+// sharded display: a master board runs the game on a canvas larger than its own leds (SCR_CANVAS_WIDTH and
+// SCR_CANVAS_HEIGHT in screen.hpp) and streams every shard (a region of it) to a follower board, which only runs
+// the output pipeline; after all shards a broadcast present packet tells the followers that the frame is complete
+// the present carries a deadline, as a delay from the end of the packet on the wire; the master and every follower
+// hold the submit of the frame until then, so all panels latch it together (see scr_screen_swap_at())
+// e.g. a 2x2 wall of 48x32 boards, the master showing the top left: SCR_CANVAS_WIDTH=96 SCR_CANVAS_HEIGHT=64
+// on the master, SHARD_COUNT=3, SHARD_REGIONS="{{48, 0, 48, 32}, {0, 32, 48, 32}, {48, 32, 48, 32}}" and
+// SHARD_ID=0, 1 or 2 on the followers
+//
+// packet: magic, type, shard, seq, length (2 bytes, le), payload, fletcher-16 of type..payload (2 bytes, le)
+// key payload:   width, height, width * height rgb triples
+// delta payload: width, height, then runs of (skip, count, count rgb triples) against the previous frame;
+//                pixels after the last run are unchanged
+// present:       delay_us (4 bytes, le); shard is SHARD_BROADCAST and seq the frame to show
+#define SHARD_ROLE_NONE 0
+#define SHARD_ROLE_MASTER 1
+#define SHARD_ROLE_FOLLOWER 2
+
+#ifndef SHARD_ROLE
+#define SHARD_ROLE SHARD_ROLE_NONE
+#endif
+#ifndef SHARD_COUNT
+#define SHARD_COUNT 1
+#endif
+#ifndef SHARD_REGIONS // x0, y0, width, height of every shard on the master canvas
+#define SHARD_REGIONS {{0, 0, screen::PANEL_WIDTH, screen::PANEL_HEIGHT}}
+#endif
+#ifndef SHARD_ID // this follower's shard
+#define SHARD_ID 0
+#endif
+#ifndef SHARD_PRESENT_DELAY_US // must cover a follower's wait for its next refresh, its pipeline and the led frame in flight
+#define SHARD_PRESENT_DELAY_US 16000
+#endif
+#ifndef SHARD_KEY_INTERVAL // frames between key frames, so followers that lost a packet recover
+#define SHARD_KEY_INTERVAL 60
+#endif
+#ifndef SHARD_UART_BAUD
+#define SHARD_UART_BAUD 3000000
+#endif
+#ifndef SHARD_UART_TX_PIN
+#define SHARD_UART_TX_PIN 8
+#endif
+#ifndef SHARD_UART_RX_PIN
+#define SHARD_UART_RX_PIN 9
+#endif
+
+namespace shard
+{
+    const uint8_t SHARD_MAGIC = 0xa5;
+    const uint8_t SHARD_BROADCAST = 0xff;
+    const auto SHARD_HEADER_BYTES = 6;
+    const auto SHARD_CHECKSUM_BYTES = 2;
+    const auto SHARD_MAX_PIXELS = screen::PANEL_WIDTH * screen::PANEL_HEIGHT; // a shard fits the leds of a follower
+    const auto SHARD_MAX_PAYLOAD = 2 + 3 * SHARD_MAX_PIXELS;
+    const auto SHARD_MAX_PACKET = SHARD_HEADER_BYTES + SHARD_MAX_PAYLOAD + SHARD_CHECKSUM_BYTES;
+    const auto SHARD_PRESENT_PAYLOAD = 4;
+    const auto SHARD_PRESENT_PACKET = SHARD_HEADER_BYTES + SHARD_PRESENT_PAYLOAD + SHARD_CHECKSUM_BYTES;
+    const auto SHARD_MAX_FRAME = SHARD_COUNT * SHARD_MAX_PACKET + SHARD_PRESENT_PACKET; // all shards and the present
+
+    enum shard_packet_type_t : uint8_t
+    {
+        SHARD_PACKET_KEY = 1,
+        SHARD_PACKET_DELTA,
+        SHARD_PACKET_PRESENT,
+    };
+
+    typedef struct
+    {
+        int x0, y0, width, height;
+    } shard_region_t;
+
+    // a byte link between the boards; write starts sending and may return before the data is out, which must stay
+    // untouched (and no other write be started) while busy returns true; read returns the number of bytes read,
+    // 0 when nothing is pending
+    typedef void (*shard_link_write_t)(const uint8_t *data, const size_t length);
+    typedef bool (*shard_link_busy_t)();
+    typedef size_t (*shard_link_read_t)(uint8_t *data, const size_t max_length);
+    typedef struct
+    {
+        shard_link_write_t write;
+        shard_link_busy_t busy;
+        shard_link_read_t read;
+        uint32_t byte_ns; // time a byte takes on the wire
+    } shard_link_t;
+
+    // master side: one encoder per shard, holding what the follower was last sent
+    typedef struct
+    {
+        uint8_t id;
+        shard_region_t region;
+        int frames_since_key;
+        ws2812::led_color_t previous[SHARD_MAX_PIXELS];
+    } shard_encoder_t;
+
+    void shard_encoder_init(shard_encoder_t &encoder, const uint8_t id, const shard_region_t &region);
+    // writes the packet of the shard for frame seq, a delta unless a key frame is due or smaller; returns its length
+    size_t shard_encode(shard_encoder_t &encoder, const uint8_t seq, const ws2812::led_color_t *frame, const int stride, uint8_t *packet);
+    size_t shard_encode_present(const uint8_t seq, const uint32_t delay_us, uint8_t *packet);
+    // the packets of all count shards and the present of frame seq back to back; returns their total length
+    size_t shard_encode_frame(shard_encoder_t *encoders, const int count, const uint8_t seq, const uint32_t delay_us, const ws2812::led_color_t *frame, const int stride, uint8_t *packets);
+    // the present deadline of length bytes written to link at written, whose present carries delay_us
+    absolute_time_t shard_present_deadline(const shard_link_t &link, const absolute_time_t written, const size_t length, const uint32_t delay_us);
+
+    // follower side: packets are parsed byte by byte, so a lost or corrupt byte only costs the packet it is in
+    typedef enum
+    {
+        SHARD_EVENT_NONE,
+        SHARD_EVENT_REGION,  // frame was updated
+        SHARD_EVENT_PRESENT, // frame is complete and can be shown
+    } shard_event_t;
+
+    typedef struct
+    {
+        uint8_t id;
+        bool in_sync; // a key frame was received and no delta was missed since
+        uint8_t seq;  // of the last region applied
+        size_t received;
+        size_t expected;
+        uint32_t packets_dropped;
+        absolute_time_t present_at; // deadline of the last present, from the time it was parsed
+        uint8_t packet[SHARD_MAX_PACKET];
+        ws2812::led_color_t frame[screen::PANEL_HEIGHT][screen::PANEL_WIDTH];
+    } shard_decoder_t;
+
+    void shard_decoder_init(shard_decoder_t &decoder, const uint8_t id);
+    shard_event_t shard_decoder_push(shard_decoder_t &decoder, const uint8_t byte);
+
+    // role glue, driven by SHARD_ROLE
+    // the master encodes a frame into a staging buffer as core1 takes it, and the link sends it from there while
+    // core1 runs its own tiles; a frame that finds the link still busy with the previous one is not sent
+#if SHARD_ROLE == SHARD_ROLE_MASTER
+    void shard_master_init(const shard_link_t &link); // before the screen starts core1
+    // every shard, then the present; true with the present deadline of the frame when it was sent
+    bool shard_master_send_frame(const ws2812::led_color_t *frame, const int stride, absolute_time_t &present_at);
+    uint32_t shard_master_bytes_sent();
+#endif
+#if SHARD_ROLE == SHARD_ROLE_FOLLOWER
+    void shard_follower_init(const shard_link_t &link);
+    // reads the link up to the next present; true, with its deadline, when the frame should be shown
+    bool shard_follower_poll(absolute_time_t &present_at);
+    const ws2812::led_color_t (*shard_follower_frame())[screen::PANEL_WIDTH];
+#endif
+
+#ifdef HOST_BUILD
+    // stand-in for the wire: whatever is written is read back, a byte every byte_ns after the write
+    shard_link_t shard_link_loopback(const uint32_t byte_ns = 0);
+#else
+    shard_link_t shard_link_uart();
+#endif
+}
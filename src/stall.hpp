@@ -0,0 +1,59 @@
+#pragma once
+
+#include <pico/platform.h>
+#include <pico/time.h>
+#include <stdint.h>
+
+// wait accounting of a sync point: how often each core passed it, how often it had to wait there and for how long
+// the counters of a core are only written by that core
+namespace stall
+{
+    typedef struct
+    {
+        uint32_t entries[2];
+        uint32_t waits[2];
+        int64_t total_us[2];
+        int64_t max_us[2];
+        int64_t busy_us[2]; // spent on other work while waiting, e.g. helping the core waited for; not in total_us
+    } stall_counter_t;
+
+    static inline void stall_waited(stall_counter_t &counter, const uint core, const absolute_time_t start, const int64_t busy_us = 0)
+    {
+        const int64_t wait = absolute_time_diff_us(start, get_absolute_time()) - busy_us;
+        counter.busy_us[core] += busy_us;
+        counter.waits[core]++;
+        counter.total_us[core] += wait;
+        if (wait > counter.max_us[core])
+        {
+            counter.max_us[core] = wait;
+        }
+    }
+
+    // try_enter() first, so an entry that does not wait costs no clock reads; enter() blocks until it succeeds
+    template <typename TRY_ENTER, typename ENTER>
+    static inline void stall_enter(stall_counter_t &counter, TRY_ENTER try_enter, ENTER enter)
+    {
+        const uint core = get_core_num();
+        counter.entries[core]++;
+        if (!try_enter())
+        {
+            const absolute_time_t start = get_absolute_time();
+            enter();
+            stall_waited(counter, core, start);
+        }
+    }
+
+    // as stall_enter(), but enter() returns the microseconds of other work it did while waiting
+    template <typename TRY_ENTER, typename ENTER>
+    static inline void stall_enter_busy(stall_counter_t &counter, TRY_ENTER try_enter, ENTER enter)
+    {
+        const uint core = get_core_num();
+        counter.entries[core]++;
+        if (!try_enter())
+        {
+            const absolute_time_t start = get_absolute_time();
+            const int64_t busy_us = enter();
+            stall_waited(counter, core, start, busy_us);
+        }
+    }
+}
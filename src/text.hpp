@@ -0,0 +1,179 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "blend.hpp"
+#include "fonts.hpp"
+#include "screen.hpp"
+
+// allocation-free 3x5 text engine
+// the packed two-glyphs-per-row font is expanded at compile time into one 15-bit mask per glyph;
+// glyphs are drawn a clipped row at a time and numbers are converted to digits without any buffer
+namespace screen
+{
+    enum font_3x5_alignment_t
+    {
+        FONT_3X5_CENTER = 0,
+        FONT_3X5_LEFT = 1,
+        FONT_3X5_RIGHT = 2
+    };
+
+    const auto FONT_3X5_ADVANCE = 4; // glyph width plus one column of spacing
+
+    // glyph mask: row r (0 at the top) is in bits 14 - 3r .. 12 - 3r, the leftmost pixel in the highest bit
+    constexpr uint16_t __font_3x5_pack(const uint8_t *rows, const bool low_half)
+    {
+        uint16_t mask = 0;
+        for (int row = 0; row < 5; row++)
+        {
+            mask = (mask << 3) | ((low_half ? rows[row] : rows[row] >> 3) & 0b111);
+        }
+        return mask;
+    }
+
+    constexpr uint16_t __font_3x5_expand(const char ch)
+    {
+        if (ch >= 32 && ch <= 96)
+        {
+            return __font_3x5_pack(font_3x5_32_96_optimized[(ch - 32) / 2], (ch - 32) % 2);
+        }
+        if (ch >= 'a' && ch <= 'z')
+        {
+            return __font_3x5_expand(ch - 'a' + 'A');
+        }
+        if (ch >= 123 && ch <= 126)
+        {
+            return __font_3x5_pack(font_3x5_122_126_optimized[(ch - 122) / 2], (ch - 122) % 2);
+        }
+        return __font_3x5_pack(font_3x5_missing_char, false);
+    }
+
+    typedef struct
+    {
+        uint16_t mask[256];
+    } font_3x5_glyphs_t;
+
+    constexpr font_3x5_glyphs_t __font_3x5_expand_all()
+    {
+        font_3x5_glyphs_t glyphs = {};
+        for (int ch = 0; ch < 256; ch++)
+        {
+            glyphs.mask[ch] = __font_3x5_expand((char)ch);
+        }
+        return glyphs;
+    }
+
+    static constexpr font_3x5_glyphs_t font_3x5_glyphs = __font_3x5_expand_all();
+
+    static inline uint16_t font_3x5_glyph(const char ch)
+    {
+        return font_3x5_glyphs.mask[(uint8_t)ch];
+    }
+
+    // length known at compile time for constant strings, e.g. static constexpr auto title = text_3x5("PONG");
+    typedef struct
+    {
+        const char *str;
+        int length;
+    } text_3x5_t;
+
+    constexpr text_3x5_t text_3x5(const char *str)
+    {
+        int length = 0;
+        while (str[length])
+        {
+            length++;
+        }
+        return {str, length};
+    }
+
+    constexpr int text_3x5_width(const int length)
+    {
+        return length ? length * FONT_3X5_ADVANCE - 1 : 0;
+    }
+
+    // left edge of a run of length glyphs, aligned on x
+    constexpr int __text_3x5_left(const int x, const int length, const font_3x5_alignment_t alignment)
+    {
+        return alignment == FONT_3X5_CENTER  ? x - length * FONT_3X5_ADVANCE / 2
+               : alignment == FONT_3X5_RIGHT ? x - length * FONT_3X5_ADVANCE + 1
+                                             : x;
+    }
+
+    // x and y are the top left corner of the glyph
+    // the text functions draw into rgb, indexed and deep colour frame buffers alike
+    template <typename FRAME_BUFFER, typename COLOR, typename BLEND = blend_replace>
+    static inline void draw_3x5_glyph(FRAME_BUFFER &fb, const uint16_t glyph, const int x, const int y, const COLOR c, const BLEND &blend = BLEND())
+    {
+        if (x <= -3 || x >= SCREEN_WIDTH || y <= -5 || y >= SCREEN_HEIGHT)
+        {
+            return;
+        }
+
+        // clip once per glyph: visible columns as a row mask, visible rows as a range
+        uint8_t columns = 0b111;
+        if (x < 0)
+        {
+            columns &= 0b111 >> -x;
+        }
+        if (x > SCREEN_WIDTH - 3)
+        {
+            columns &= 0b111 << (x - (SCREEN_WIDTH - 3));
+        }
+        const int row_begin = y < 0 ? -y : 0;
+        const int row_end = y + 5 > SCREEN_HEIGHT ? SCREEN_HEIGHT - y : 5;
+        const auto src = blend_source(c);
+
+        for (int row = row_begin; row < row_end; row++)
+        {
+            const uint8_t bits = (glyph >> (12 - 3 * row)) & columns;
+            auto *line = fb[y + row];
+            if (bits & 0b100)
+            {
+                blend_into(line[x], src, blend);
+            }
+            if (bits & 0b010)
+            {
+                blend_into(line[x + 1], src, blend);
+            }
+            if (bits & 0b001)
+            {
+                blend_into(line[x + 2], src, blend);
+            }
+        }
+    }
+
+    template <typename FRAME_BUFFER, typename COLOR, typename BLEND = blend_replace>
+    static inline void draw_3x5_text(FRAME_BUFFER &fb, const text_3x5_t &text, const int x, const int y, const COLOR c, const font_3x5_alignment_t alignment = FONT_3X5_LEFT, const BLEND &blend = BLEND())
+    {
+        int left = __text_3x5_left(x, text.length, alignment);
+        for (int i = 0; i < text.length; i++, left += FONT_3X5_ADVANCE)
+        {
+            draw_3x5_glyph(fb, font_3x5_glyph(text.str[i]), left, y, c, blend);
+        }
+    }
+
+    static inline int text_3x5_digits(uint32_t number)
+    {
+        int digits = 1;
+        while (number >= 10)
+        {
+            number /= 10;
+            digits++;
+        }
+        return digits;
+    }
+
+    // digits are produced least significant first, right to left, straight from the number
+    template <typename FRAME_BUFFER, typename COLOR, typename BLEND = blend_replace>
+    static inline void draw_3x5_unsigned(FRAME_BUFFER &fb, uint32_t number, const int x, const int y, const COLOR c, const font_3x5_alignment_t alignment = FONT_3X5_LEFT, const BLEND &blend = BLEND())
+    {
+        const int digits = text_3x5_digits(number);
+        int left = __text_3x5_left(x, digits, alignment) + (digits - 1) * FONT_3X5_ADVANCE;
+        for (int i = 0; i < digits; i++, left -= FONT_3X5_ADVANCE)
+        {
+            draw_3x5_glyph(fb, font_3x5_glyphs.mask['0' + number % 10], left, y, c, blend);
+            number /= 10;
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#include <string.h>
+
+#include "trace.hpp"
+
+namespace trace
+{
+    trace_record_t trace_ring[TRACE_EVENTS ? TRACE_EVENTS : 1];
+    std::atomic<uint32_t> trace_count(0);
+
+    static const char *const __names[TRACE_NAMES] = {
+        "game_update",
+        "game_draw",
+        "swap_wait",
+        "rasterise",
+        "tiles",
+        "end_frame",
+        "submit",
+        "resubmit",
+        "dma_done",
+        "latched",
+        "present_hold",
+    };
+
+    const char *trace_name(const trace_name_t name)
+    {
+        return name < TRACE_NAMES ? __names[name] : "unknown";
+    }
+
+    bool trace_name_find(const char *text, trace_name_t &name)
+    {
+        for (int i = 0; i < TRACE_NAMES; i++)
+        {
+            if (!strcmp(text, __names[i]))
+            {
+                name = (trace_name_t)i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void trace_clear()
+    {
+        trace_count.store(0);
+    }
+
+    uint32_t trace_snapshot(trace_record_t *records, const uint32_t max_records)
+    {
+        const uint32_t count = trace_count.load();
+        uint32_t n = count < TRACE_EVENTS ? count : TRACE_EVENTS;
+        n = n < max_records ? n : max_records;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            records[i] = trace_ring[(count - n + i) & (TRACE_EVENTS - 1)];
+        }
+        return n;
+    }
+
+    void trace_dump(FILE *out)
+    {
+        const uint32_t count = trace_count.load();
+        const uint32_t n = count < TRACE_EVENTS ? count : TRACE_EVENTS;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            const trace_record_t &record = trace_ring[(count - n + i) & (TRACE_EVENTS - 1)];
+            fprintf(out, "trace %lu %u %c %s\n", (unsigned long)record.time_us, record.core, record.phase, trace_name(record.name));
+        }
+    }
+
+    bool trace_parse_line(const char *line, trace_record_t &record)
+    {
+        unsigned long time_us;
+        unsigned core;
+        char phase;
+        char name[32];
+        if (sscanf(line, "trace %lu %u %c %31s", &time_us, &core, &phase, name) != 4 ||
+            (phase != TRACE_BEGIN && phase != TRACE_END && phase != TRACE_INSTANT) ||
+            !trace_name_find(name, record.name))
+        {
+            return false;
+        }
+        record.time_us = time_us;
+        record.core = core;
+        record.phase = (trace_phase_t)phase;
+        record.padding = 0;
+        return true;
+    }
+
+    void trace_write_json(FILE *out, const trace_record_t *records, const uint32_t count)
+    {
+        fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"core0\"}},\n");
+        fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"core1\"}}");
+
+        // trace_emit() claims a slot before it reads the clock, so an interrupt or the other core can stamp a later
+        // slot first and neighbouring records may step back a little;
+        // only a step back of more than half the range is a wrap of the 32-bit clock
+        uint64_t high = 0;
+        uint32_t last = count ? records[0].time_us : 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const trace_record_t &record = records[i];
+            if (record.time_us < last && last - record.time_us > 0x80000000u)
+            {
+                high += 1ull << 32;
+            }
+            last = record.time_us;
+            fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":0,\"tid\":%u%s}",
+                    trace_name(record.name), record.phase, (unsigned long long)(high + record.time_us), record.core,
+                    record.phase == TRACE_INSTANT ? ",\"s\":\"t\"" : "");
+        }
+        fprintf(out, "\n]}\n");
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <pico/platform.h>
+#include <pico/time.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// event trace: begin, end and instant records of both cores and of interrupts on one timeline
+// records go into a ring that keeps the last TRACE_EVENTS of them; trace_dump() prints them as text lines,
+// which the host converter (tools/trace_to_json.cpp) turns into chrome trace event json for perfetto
+// or chrome://tracing
+#ifndef TRACE_EVENTS // a power of two; 0 compiles the trace out
+#ifdef HOST_BUILD
+#define TRACE_EVENTS 1024
+#else
+#define TRACE_EVENTS 0
+#endif
+#endif
+
+namespace trace
+{
+    static_assert((TRACE_EVENTS & (TRACE_EVENTS - 1)) == 0, "TRACE_EVENTS must be a power of two");
+
+    // the names of the events; add new ones before TRACE_NAMES and in trace_name()
+    typedef enum : uint8_t
+    {
+        TRACE_GAME_UPDATE,
+        TRACE_GAME_DRAW,
+        TRACE_SWAP_WAIT,  // core0 waiting for core1 to release the frame, helping with tiles meanwhile
+        TRACE_RASTERISE,
+        TRACE_TILES,      // lut, palette and tile stages of a frame
+        TRACE_END_FRAME,  // transport conversion, e.g. bit planes
+        TRACE_SUBMIT,     // waiting for the previous frame and starting this one
+        TRACE_RESUBMIT,
+        TRACE_DMA_DONE,   // ws2812 dma completion irq
+        TRACE_LATCHED,    // ws2812 reset alarm
+        TRACE_PRESENT_HOLD, // core1 holding a frame until its present deadline
+        TRACE_NAMES,
+    } trace_name_t;
+
+    typedef enum : uint8_t
+    {
+        TRACE_BEGIN = 'B',
+        TRACE_END = 'E',
+        TRACE_INSTANT = 'i',
+    } trace_phase_t;
+
+    typedef struct
+    {
+        uint32_t time_us; // low 32 bits of the time since boot
+        trace_name_t name;
+        trace_phase_t phase;
+        uint8_t core;
+        uint8_t padding;
+    } trace_record_t;
+
+    extern trace_record_t trace_ring[TRACE_EVENTS ? TRACE_EVENTS : 1];
+    extern std::atomic<uint32_t> trace_count; // records written since the last trace_clear()
+
+    // one atomic add claims the slot, so the cores and interrupts never wait on each other
+    static inline void trace_emit(const trace_name_t name, const trace_phase_t phase)
+    {
+        if (TRACE_EVENTS)
+        {
+            trace_record_t &record = trace_ring[trace_count.fetch_add(1, std::memory_order_relaxed) & (TRACE_EVENTS - 1)];
+            record.time_us = time_us_32();
+            record.name = name;
+            record.phase = phase;
+            record.core = get_core_num();
+        }
+    }
+
+    static inline void trace_begin(const trace_name_t name)
+    {
+        trace_emit(name, TRACE_BEGIN);
+    }
+
+    static inline void trace_end(const trace_name_t name)
+    {
+        trace_emit(name, TRACE_END);
+    }
+
+    static inline void trace_instant(const trace_name_t name)
+    {
+        trace_emit(name, TRACE_INSTANT);
+    }
+
+    const char *trace_name(const trace_name_t name);
+    bool trace_name_find(const char *text, trace_name_t &name);
+
+    void trace_clear();
+    // the records in the ring, oldest first; returns their number
+    uint32_t trace_snapshot(trace_record_t *records, const uint32_t max_records);
+    // one line per record: "trace <time_us> <core> <phase> <name>"
+    void trace_dump(FILE *out);
+    // parses a line of trace_dump(); false for any other line
+    bool trace_parse_line(const char *line, trace_record_t &record);
+    // chrome trace event json; the 32-bit times are unwrapped, records must be in the order they were written
+    void trace_write_json(FILE *out, const trace_record_t *records, const uint32_t count);
+}
@@ -2,10 +2,14 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "latency.hpp"
 #include "pong_game.hpp"
 #include "rotary_encoder.hpp"
 #include "screen.hpp"
+#include "shard.hpp"
+#include "trace.hpp"
 
 // Initialize the GPIO for the LED
 void status_led_init(void)
@@ -34,42 +38,101 @@ int main()
     stdio_init_all();
     status_led_init();
 
+#if SHARD_ROLE == SHARD_ROLE_MASTER
+    // the link must be up before core1 draws its first frame
+    shard::shard_master_init(shard::shard_link_uart());
+#endif
     screen::scr_screen_init();
+
+#if SHARD_ROLE == SHARD_ROLE_FOLLOWER
+    // followers only show the frames the master sends, at the deadline the master set for them; the link is
+    // polled without pause, so a present is seen as its last byte arrives
+    shard::shard_follower_init(shard::shard_link_uart());
+    while (true)
+    {
+        absolute_time_t present_at;
+        if (shard::shard_follower_poll(present_at))
+        {
+            memcpy(*screen::scr_screen, shard::shard_follower_frame(), sizeof(screen::scr_frame_buffer_t));
+            screen::scr_screen_swap_at(true, true, present_at);
+        }
+    }
+#endif
+
     rotary_encoder::rotary_encoders_init();
 
     int frame = 0;
     int frame_rate = 0;
 
     absolute_time_t last_time = get_absolute_time();
-    absolute_time_t last_frame_time = last_time;
+    absolute_time_t last_present_time = last_time;
+    int64_t draw_time = 0;
 
     pong_game::game_init();
     while (true)
     {
         set_status_led(frame & 1);
 
+        // one frame per refresh of core1, started as core1 takes the previous one
+        screen::scr_wait_refresh();
+
         const absolute_time_t current_frame_time = get_absolute_time();
-        if (absolute_time_diff_us(last_time, current_frame_time) >= 1000000)
+        const bool second_passed = absolute_time_diff_us(last_time, current_frame_time) >= 1000000;
+        if (second_passed)
         {
             frame_rate = frame;
             frame = 0;
             last_time = current_frame_time;
         }
 
-        pong_game::game_update(current_frame_time, absolute_time_diff_us(last_frame_time, current_frame_time));
-        last_frame_time = current_frame_time;
+        // the game is advanced to the time the frame will be on the leds, not the time it is drawn
+        const absolute_time_t present_time = screen::scr_predict_present(delayed_by_us(current_frame_time, draw_time));
+        const int64_t delta_time = absolute_time_diff_us(last_present_time, present_time);
+        if (delta_time > 0)
+        {
+            trace::trace_begin(trace::TRACE_GAME_UPDATE);
+            pong_game::game_update(present_time, delta_time);
+            trace::trace_end(trace::TRACE_GAME_UPDATE);
+            last_present_time = present_time;
+        }
+        trace::trace_begin(trace::TRACE_GAME_DRAW);
         pong_game::game_draw(true, true);
+        trace::trace_end(trace::TRACE_GAME_DRAW);
+        draw_time = absolute_time_diff_us(current_frame_time, get_absolute_time());
 
-        printf("FPS %d; ", frame_rate);
-        // printf("unit tests %s; ", tests ? "passed" : "failed");
-        // printf("PIOs/SMs (%ld, %d) (%ld, %d) (%ld, %d); ", (int32_t)pio[0], sm[0], (int32_t)pio[1], sm[1], (int32_t)pio[2], sm[2]);
-        printf("gamma_correction: %06lld us; ", screen::scr_profile.time_gamma_correction);
-        printf("dithering: %06lld us; ", screen::scr_profile.time_dithering);
-        printf("screen_to_led_colors: %06lld us; ", screen::scr_profile.time_screen_to_led_colors);
-        printf("led_colors_to_bitplanes: %06lld us; ", screen::scr_profile.time_led_colors_to_bitplanes);
-        printf("DMA: %06lld us", screen::scr_profile.time_wait_for_DMA);
-        printf("\n");
+        // the summary goes out once per second, with the new frame rate; the serial link would slow every frame
+        if (second_passed)
+        {
+            printf("FPS %d; ", frame_rate);
+            // printf("unit tests %s; ", tests ? "passed" : "failed");
+            // printf("PIOs/SMs (%ld, %d) (%ld, %d) (%ld, %d); ", (int32_t)pio[0], sm[0], (int32_t)pio[1], sm[1], (int32_t)pio[2], sm[2]);
+            printf("rasterise: %06lld us; ", screen::scr_profile.time_rasterise);
+            printf("gamma_correction: %06lld us; ", screen::scr_profile.time_gamma_correction);
+            printf("dithering: %06lld us; ", screen::scr_profile.time_dithering);
+            printf("screen_to_led_colors: %06lld us; ", screen::scr_profile.time_screen_to_led_colors);
+            printf("pixel_pipeline: %06lld us (core0 %06lld us, core1 %06lld us); ", screen::scr_profile.time_pixel_pipeline, screen::scr_profile.time_tiles_core0, screen::scr_profile.time_tiles_core1);
+            printf("led_colors_to_bitplanes: %06lld us; ", screen::scr_profile.time_led_colors_to_bitplanes);
+            printf("DMA: %06lld us; ", screen::scr_profile.time_wait_for_DMA);
+            printf("power: %lld mA (limit %lld/256); ", screen::scr_profile.power_estimate_mA, screen::scr_profile.power_limit);
+            printf("present: +%lld us; ", absolute_time_diff_us(current_frame_time, present_time));
+            const screen::scr_stalls_t &stalls = screen::scr_stalls;
+            printf("waits: swap %lu/%lu %lld us (max %lld us, helping %lld us), fence %lu %lld us (max %lld us), fifo %lld us, present hold %lu/%lu %lld us; ",
+                   (unsigned long)stalls.swap_lock.waits[0], (unsigned long)stalls.swap_lock.entries[0], stalls.swap_lock.total_us[0], stalls.swap_lock.max_us[0], stalls.swap_lock.busy_us[0],
+                   (unsigned long)stalls.transmit_fence.waits[1], stalls.transmit_fence.total_us[1], stalls.transmit_fence.max_us[1], stalls.tx_fifo.total_us[1],
+                   (unsigned long)stalls.present_hold.waits[1], (unsigned long)stalls.present_hold.entries[1], stalls.present_hold.total_us[1]);
+            printf("frames dropped %lu, repeated %lu; ", (unsigned long)stalls.frames_dropped, (unsigned long)stalls.frames_repeated);
+            const latency::latency_stats_t latency = latency::latency_stats();
+            printf("input latency: %lu samples, p50 %lld us, p90 %lld us, p99 %lld us, max %lld us", (unsigned long)latency.samples, latency.p50_us, latency.p90_us, latency.p99_us, latency.max_us);
+            printf("\n");
+        }
         frame++;
+
+        // a full trace ring is printed for tools/trace_to_json, then the next one starts
+        if (TRACE_EVENTS && trace::trace_count.load() >= TRACE_EVENTS)
+        {
+            trace::trace_dump(stdout);
+            trace::trace_clear();
+        }
     }
     pong_game::game_exit();
 }
@@ -3,12 +3,13 @@
 #include <pico/mutex.h>
 #include <string.h>
 
+#include "seqlock.hpp"
+#include "trace.hpp"
 #include "ws2812.hpp"
 #include "ws2812.pio.h"
 
 namespace ws2812
 {
-    static const auto WS2812_RESET_US = 80;
     static const auto WS2812_PIN_BASE = 2;
 
 #if WS2812_PIN_BASE >= NUM_BANK0_GPIOS
@@ -48,11 +49,31 @@ namespace ws2812
     // posted when it is safe to output a new set of values to ws2812
     mutex_t __mutex_transmitting_led_colors;
 
+    stall::stall_counter_t led_colors_lock_stalls;
+    stall::stall_counter_t led_colors_fifo_stalls;
+
     // alarm handle for handling the ws2812 reset delay
     static alarm_id_t ws2812_reset_alarm_id = 0;
 
+    // stamped by the dma irq, published with the latch time by the reset alarm
+    static absolute_time_t __dma_done_time;
+    static seqlock::seqlock_t<led_colors_latch_t> __latch = {};
+
+    led_colors_latch_t led_colors_last_latch()
+    {
+        return seqlock::seqlock_read(__latch);
+    }
+
     int64_t ws2812_reset_completed(__unused alarm_id_t id, __unused void *user_data)
     {
+        seqlock::seqlock_write(__latch, [](led_colors_latch_t &latch)
+                               {
+                                   latch.frames++;
+                                   latch.dma_done = __dma_done_time;
+                                   latch.latched = get_absolute_time();
+                               });
+        trace::trace_instant(trace::TRACE_LATCHED);
+
         ws2812_reset_alarm_id = 0;
         mutex_exit(&__mutex_transmitting_led_colors);
         // no repeat
@@ -65,6 +86,8 @@ namespace ws2812
         {
             // clear IRQ
             dma_hw->ints0 = ws2812_dma_mask;
+            __dma_done_time = get_absolute_time();
+            trace::trace_instant(trace::TRACE_DMA_DONE);
 
             // when the dma is complete we start the reset delay timer
             if (ws2812_reset_alarm_id)
@@ -78,8 +101,8 @@ namespace ws2812
             ws2812_reset_alarm_id = add_alarm_in_us(WS2812_RESET_US + (8 + 1) * 1.25, ws2812_reset_completed, NULL, true);
 #endif
 #ifdef WS2812_SINGLE
-            // assume that the SM fifo is full (8 words) and one word is in progress. Add time to wait for all bits (3 * 8) to be sent
-            ws2812_reset_alarm_id = add_alarm_in_us(WS2812_RESET_US + (8 + 1) * 3 * 8 * 1.25, ws2812_reset_completed, NULL, true);
+            // assume that the SM fifo is full (8 words) and one word is in progress. Add time to wait for all bits (3 or 4 * 8) to be sent
+            ws2812_reset_alarm_id = add_alarm_in_us(WS2812_RESET_US + (8 + 1) * MAX_CHANNELS_PER_LED * 8 * 1.25, ws2812_reset_completed, NULL, true);
 #endif
         }
     }
@@ -117,7 +140,6 @@ namespace ws2812
             dma_channel_config channel_config = dma_channel_get_default_config(ws2812_dma_channels[i]);
             channel_config_set_dreq(&channel_config, pio_get_dreq(pio[i], sm[i], true));
             channel_config_set_transfer_data_size(&channel_config, DMA_SIZE_32);
-            channel_config_set_irq_quiet(&channel_config, i != 0);
 
             dma_channel_configure(
                 ws2812_dma_channels[i],
@@ -128,10 +150,7 @@ namespace ws2812
                 false);
         }
 
-        // irq works with the first channel only
-        ws2812_dma_mask |= 1u << ws2812_dma_channels[0];
-
-        dma_channel_set_irq0_enabled(ws2812_dma_channels[0], true);
+        // the irq is taken from one of the channels started by each transmission, see __transmit_led_colors()
         irq_add_shared_handler(DMA_IRQ_0, ws2812_dma_complete_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
         irq_set_enabled(DMA_IRQ_0, true);
     }
@@ -140,7 +159,12 @@ namespace ws2812
 #ifdef WS2812_PARALLEL
     void transmit_led_colors_dma(int active_planes)
     {
-        sem_acquire_blocking(&__mutex_transmitting_led_colors);
+        stall::stall_enter(
+            led_colors_lock_stalls,
+            []
+            { return sem_try_acquire(&__mutex_transmitting_led_colors); },
+            []
+            { sem_acquire_blocking(&__mutex_transmitting_led_colors); });
         dma_channel_hw_addr(ws2812_dma_channel)
             ->al3_read_addr_trig = (uintptr_t)(led_strips_bitstream + active_planes);
     }
@@ -179,9 +203,18 @@ namespace ws2812
         auto success = true;
         for (auto i = 0; i < NMB_STRIPS && success; i++)
         {
-            success = pio_claim_free_sm_and_add_program_for_gpio_range(&ws2812_single_program, &pio[i], &sm[i], &offset[i], WS2812_PIN_BASE + i, 1, true);
+            // rgbw strips send the whole word, rgb strips skip the padding byte
+            const bool rgbw = led_format_channels(STRIP_FORMATS[i]) == 4;
+            success = pio_claim_free_sm_and_add_program_for_gpio_range(rgbw ? &ws2812_single_rgbw_program : &ws2812_single_program, &pio[i], &sm[i], &offset[i], WS2812_PIN_BASE + i, 1, true);
             hard_assert(success);
-            ws2812_single_program_init(pio[i], sm[i], offset[i], WS2812_PIN_BASE + i, 800000);
+            if (rgbw)
+            {
+                ws2812_single_rgbw_program_init(pio[i], sm[i], offset[i], WS2812_PIN_BASE + i, 800000);
+            }
+            else
+            {
+                ws2812_single_program_init(pio[i], sm[i], offset[i], WS2812_PIN_BASE + i, 800000);
+            }
 
             sm_mask[pio_get_index(pio[i])] |= 1u << sm[i];
         }
@@ -197,43 +230,125 @@ namespace ws2812
     }
 
 #ifdef WS2812_SINGLE
-    void transmit_led_colors()
+    // strips whose colours equal the previous frame are left alone: the leds keep what they latched, and their
+    // dma channel and state machine stay idle; the previous buffer always holds what the leds show, since
+    // every frame rewrites the whole buffer
+    static void __transmit_led_colors(const int buffer, const bool repeat)
     {
-        mutex_enter_blocking(&__mutex_transmitting_led_colors);
+        stall::stall_enter(
+            led_colors_lock_stalls,
+            []
+            { return mutex_try_enter(&__mutex_transmitting_led_colors, NULL); },
+            []
+            { mutex_enter_blocking(&__mutex_transmitting_led_colors); });
+
+        uint32_t changed = 0;
+        if (!repeat)
+        {
+            for (int i = 0; i < NMB_STRIPS; i++)
+            {
+                if (memcmp(__led_colors[buffer][i], __led_colors[buffer ^ 1][i], sizeof(__led_colors[buffer][i])))
+                {
+                    changed |= 1u << i;
+                }
+            }
+        }
+        if (!changed)
+        {
+            // nothing to send; keep the pace of a full transmission
+            __dma_done_time = get_absolute_time();
+            ws2812_reset_alarm_id = add_alarm_in_us(WS2812_RESET_US + LEDS_PER_STRIP * MAX_CHANNELS_PER_LED * 8 * 1.25, ws2812_reset_completed, NULL, true);
+            return;
+        }
 
         hard_assert(sizeof(sm_mask) / sizeof(uint) == 3);
         // disable all state machines
         pio_set_sm_multi_mask_enabled(pio1, sm_mask[0], sm_mask[1], sm_mask[2], false);
 
-        // configure and start the DMA channels
+        // the changed strip with the most channels per led raises the irq: the strips have the same number of
+        // leds, but rgbw strips send 32 bits per led against 24, so they are the last to finish
+        int lead = -1;
+        for (int i = 0; i < NMB_STRIPS; i++)
+        {
+            if ((changed & (1u << i)) && (lead < 0 || led_format_channels(STRIP_FORMATS[i]) > led_format_channels(STRIP_FORMATS[lead])))
+            {
+                lead = i;
+            }
+        }
         uint32_t dma_all_channel_mask = 0;
         for (int i = 0; i < NMB_STRIPS; i++)
         {
-            dma_channel_set_read_addr(ws2812_dma_channels[i], __led_colors[__led_colors_active][i], false);
             dma_all_channel_mask |= 1u << ws2812_dma_channels[i];
         }
-        dma_start_channel_mask(dma_all_channel_mask);
+        dma_hw->ints0 = dma_all_channel_mask; // completions of channels that had their irq disabled
+        for (int i = 0; i < NMB_STRIPS; i++)
+        {
+            dma_channel_set_irq0_enabled(ws2812_dma_channels[i], i == lead);
+        }
+        ws2812_dma_mask = 1u << ws2812_dma_channels[lead];
 
-        // swap the led_colors buffer
-        __led_colors_active ^= 1;
-        led_colors = &(__led_colors[__led_colors_active]);
+        // configure and start the DMA channels of the changed strips
+        uint32_t dma_channel_mask = 0;
+        uint changed_sm_mask[NUM_PIOS] = {};
+        for (int i = 0; i < NMB_STRIPS; i++)
+        {
+            if (changed & (1u << i))
+            {
+                dma_channel_set_read_addr(ws2812_dma_channels[i], __led_colors[buffer][i], false);
+                dma_channel_mask |= 1u << ws2812_dma_channels[i];
+                changed_sm_mask[pio_get_index(pio[i])] |= 1u << sm[i];
+            }
+        }
+        dma_start_channel_mask(dma_channel_mask);
 
-        // wait until all state machines have non-empty TX FIFOs
-        bool ready = false;
-        while (!ready)
+        // wait until the state machines of the changed strips have non-empty TX FIFOs
+        auto fifos_ready = [changed]
         {
-            ready = true;
+            bool ready = true;
             for (int i = 0; i < NMB_STRIPS; i++)
             {
-                ready &= !pio_sm_is_tx_fifo_empty(pio[i], sm[i]);
+                ready &= !(changed & (1u << i)) || !pio_sm_is_tx_fifo_empty(pio[i], sm[i]);
             }
-        }
+            return ready;
+        };
+        stall::stall_enter(led_colors_fifo_stalls, fifos_ready, [&]
+                           {
+                               while (!fifos_ready())
+                               {
+                               }
+                           });
+
+        // enable them in sync
+        pio_enable_sm_multi_mask_in_sync(pio1, changed_sm_mask[0], changed_sm_mask[1], changed_sm_mask[2]);
+    }
 
-        // enable all state machines in sync
-        pio_enable_sm_multi_mask_in_sync(pio1, sm_mask[0], sm_mask[1], sm_mask[2]);
+    void transmit_led_colors()
+    {
+        __transmit_led_colors(__led_colors_active, false);
+
+        // swap the led_colors buffer
+        __led_colors_active ^= 1;
+        led_colors = &(__led_colors[__led_colors_active]);
+    }
+
+    void retransmit_led_colors()
+    {
+        __transmit_led_colors(__led_colors_active ^ 1, true);
     }
 #endif
 
+    void wait_led_colors_transmitted()
+    {
+#ifdef WS2812_PARALLEL
+        sem_acquire_blocking(&__mutex_transmitting_led_colors);
+        sem_release(&__mutex_transmitting_led_colors);
+#endif
+#ifdef WS2812_SINGLE
+        mutex_enter_blocking(&__mutex_transmitting_led_colors);
+        mutex_exit(&__mutex_transmitting_led_colors);
+#endif
+    }
+
 #ifdef WS2812_PARALLEL
     void led_colors_to_bitplanes_standard(
         led_bit_planes_t *const bitplane,
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <cstdint>
+#include <pico/time.h>
 
 #define WS2812_SINGLE
 
+#include "pixel_format.hpp"
+#include "stall.hpp"
+
 namespace ws2812
 {
     const auto LED_MATRIX_WIDTH = 16;
@@ -14,6 +18,24 @@ namespace ws2812
     const auto LED_MATRICES_PER_STRIP = 1;
 
     const auto LEDS_PER_STRIP = (LED_MATRIX_WIDTH * LED_MATRIX_HEIGHT * LED_MATRICES_PER_STRIP); // two 16x16 matrices per strip
+    const auto WS2812_RESET_US = 80;
+
+    // pixel format of each strip, e.g. -DWS2812_STRIP_FORMATS="{LED_FORMAT_GRB, LED_FORMAT_GRBW, ...}"; grb by default
+#ifndef WS2812_STRIP_FORMATS
+#define WS2812_STRIP_FORMATS {}
+#endif
+    constexpr led_format_id_t STRIP_FORMATS[NMB_STRIPS] = WS2812_STRIP_FORMATS;
+
+    constexpr int strip_channels_max()
+    {
+        int channels = 3;
+        for (int i = 0; i < NMB_STRIPS; i++)
+        {
+            channels = led_format_channels(STRIP_FORMATS[i]) > channels ? led_format_channels(STRIP_FORMATS[i]) : channels;
+        }
+        return channels;
+    }
+    const auto MAX_CHANNELS_PER_LED = strip_channels_max();
 
 #ifdef WS2812_PARALLEL
 #if NMB_STRIPS > 8 // max 8 strips
@@ -23,7 +45,20 @@ namespace ws2812
     typedef uint8_t bit_plane_t; // must be wide enough to contain the number of strips
 #endif
     const auto BITS_PER_COLOR_COMPONENT = 8;
-    const auto BYTES_PER_WS2812_LED = 3;
+    // all strips are clocked out together, so they must all send the same number of bytes per led
+    const auto BYTES_PER_WS2812_LED = MAX_CHANNELS_PER_LED;
+    constexpr bool strip_channels_uniform()
+    {
+        for (int i = 0; i < NMB_STRIPS; i++)
+        {
+            if (led_format_channels(STRIP_FORMATS[i]) != BYTES_PER_WS2812_LED)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    static_assert(strip_channels_uniform(), "parallel strips cannot mix rgb and rgbw formats");
     typedef struct
     {
         bit_plane_t led[BYTES_PER_WS2812_LED][BITS_PER_COLOR_COMPONENT];
@@ -50,6 +85,8 @@ namespace ws2812
 #define ws2812_pack_color(r, g, b) ((ws2812::led_color_t){(uint8_t)(0), (uint8_t)(b), (uint8_t)(r), (uint8_t)(g)})
 #endif
 
+    // led_colors hold wire words, encoded by the strip's format; the native grb format is led_color_t itself
+    // (the padding byte carries the white channel of rgbw formats)
 #ifdef WS2812_PARALLEL
     extern led_bit_planes_t led_strips_bitstream[2][LEDS_PER_STRIP] __attribute__((aligned(4)));
     extern led_color_t led_colors[NMB_STRIPS][LEDS_PER_STRIP] __attribute__((aligned(4)));
@@ -60,9 +97,26 @@ namespace ws2812
 
     bool WS2812_init();
     void clear_led_colors();
+    // blocks until the last transmission, including the reset delay, has completed
+    void wait_led_colors_transmitted();
+
+    // the last transmission the leds latched: when its data had left the dma, and when the reset delay after
+    // it ended; an unchanged frame that was not sent counts as well, with its data done when it was started
+    typedef struct
+    {
+        uint32_t frames; // transmissions latched since init
+        absolute_time_t dma_done;
+        absolute_time_t latched;
+    } led_colors_latch_t;
+    led_colors_latch_t led_colors_last_latch(); // may be called from either core
+
+    // waits of the transmissions: for the previous one and its reset delay, and for the dma to fill the tx fifos
+    extern stall::stall_counter_t led_colors_lock_stalls;
+    extern stall::stall_counter_t led_colors_fifo_stalls;
 
 #ifdef WS2812_SINGLE
     void transmit_led_colors();
+    void retransmit_led_colors(); // the leds already show the last buffer, so this only keeps the pace of a transmission
 #endif
 
 #ifdef WS2812_PARALLEL
@@ -0,0 +1,308 @@
+#include "dma_mock.hpp"
+#include "hardware/sync.h"
+#include <cstring>
+
+namespace
+{
+    typedef struct
+    {
+        bool claimed;
+        bool busy;
+        dma_channel_config config;
+        const volatile uint8_t *read_addr;
+        volatile uint8_t *write_addr;
+        uint32_t trans_count;
+        bool irq_enabled[2];
+        bool irq_status[2];
+    } mock_dma_channel_t;
+
+    mock_dma_channel_t mock_channels[NUM_DMA_CHANNELS];
+    int mock_transfers = 0;
+
+    const int MOCK_MAX_IRQ_HANDLERS = 4;
+    irq_handler_t mock_irq_handlers[2][MOCK_MAX_IRQ_HANDLERS];
+    bool mock_irq_line_enabled[2];
+    bool mock_interrupts_disabled = false;
+
+    int irq_line(uint num)
+    {
+        return num == DMA_IRQ_1 ? 1 : 0;
+    }
+
+    void mock_dispatch_irqs()
+    {
+        if (mock_interrupts_disabled)
+        {
+            return; // delivered by restore_interrupts()
+        }
+        for (int line = 0; line < 2; line++)
+        {
+            bool pending = false;
+            for (auto &ch : mock_channels)
+            {
+                pending |= ch.irq_status[line];
+            }
+            if (!pending || !mock_irq_line_enabled[line])
+            {
+                continue;
+            }
+            for (auto handler : mock_irq_handlers[line])
+            {
+                if (handler)
+                {
+                    handler();
+                }
+            }
+        }
+    }
+
+    void mock_trigger(uint channel)
+    {
+        mock_channels[channel].busy = mock_channels[channel].trans_count > 0;
+    }
+}
+
+namespace dma_mock
+{
+    void mock_dma_reset()
+    {
+        memset(mock_channels, 0, sizeof(mock_channels));
+        memset(mock_irq_handlers, 0, sizeof(mock_irq_handlers));
+        memset(mock_irq_line_enabled, 0, sizeof(mock_irq_line_enabled));
+        mock_transfers = 0;
+        mock_interrupts_disabled = false;
+    }
+
+    bool mock_dma_step()
+    {
+        for (uint channel = 0; channel < NUM_DMA_CHANNELS; channel++)
+        {
+            mock_dma_channel_t &ch = mock_channels[channel];
+            if (!ch.busy)
+            {
+                continue;
+            }
+
+            const int size = 1 << ch.config.size;
+            for (uint32_t i = 0; i < ch.trans_count; i++)
+            {
+                memcpy((void *)ch.write_addr, (const void *)ch.read_addr, size);
+                ch.read_addr += ch.config.read_increment ? size : 0;
+                ch.write_addr += ch.config.write_increment ? size : 0;
+            }
+            ch.busy = false;
+            mock_transfers++;
+
+            if (!ch.config.irq_quiet)
+            {
+                ch.irq_status[0] |= ch.irq_enabled[0];
+                ch.irq_status[1] |= ch.irq_enabled[1];
+            }
+            if (ch.config.chain_to != channel)
+            {
+                mock_trigger(ch.config.chain_to);
+            }
+            mock_dispatch_irqs();
+            return true;
+        }
+        return false;
+    }
+
+    void mock_dma_run()
+    {
+        while (mock_dma_step())
+        {
+        }
+    }
+
+    int mock_dma_transfers()
+    {
+        return mock_transfers;
+    }
+}
+
+void tight_loop_contents()
+{
+    dma_mock::mock_dma_step();
+}
+
+uint32_t save_and_disable_interrupts()
+{
+    const uint32_t status = mock_interrupts_disabled;
+    mock_interrupts_disabled = true;
+    return status;
+}
+
+void restore_interrupts(uint32_t status)
+{
+    mock_interrupts_disabled = status;
+    mock_dispatch_irqs();
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t /*order_priority*/)
+{
+    for (auto &h : mock_irq_handlers[irq_line(num)])
+    {
+        if (!h)
+        {
+            h = handler;
+            return;
+        }
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+    mock_irq_line_enabled[irq_line(num)] = enabled;
+}
+
+int dma_claim_unused_channel(bool /*required*/)
+{
+    for (int channel = 0; channel < NUM_DMA_CHANNELS; channel++)
+    {
+        if (!mock_channels[channel].claimed)
+        {
+            mock_channels[channel].claimed = true;
+            return channel;
+        }
+    }
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel)
+{
+    mock_channels[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    return dma_channel_config{DMA_SIZE_32, true, false, channel, false};
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+    c->size = size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+    c->read_increment = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+    c->write_increment = incr;
+}
+
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to)
+{
+    c->chain_to = chain_to;
+}
+
+void channel_config_set_irq_quiet(dma_channel_config *c, bool irq_quiet)
+{
+    c->irq_quiet = irq_quiet;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    dma_channel_set_read_addr(channel, read_addr, false);
+    dma_channel_set_write_addr(channel, write_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, false);
+    dma_channel_set_config(channel, config, trigger);
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger)
+{
+    mock_channels[channel].config = *config;
+    if (trigger)
+    {
+        mock_trigger(channel);
+    }
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger)
+{
+    mock_channels[channel].read_addr = (const volatile uint8_t *)read_addr;
+    if (trigger)
+    {
+        mock_trigger(channel);
+    }
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger)
+{
+    mock_channels[channel].write_addr = (volatile uint8_t *)write_addr;
+    if (trigger)
+    {
+        mock_trigger(channel);
+    }
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger)
+{
+    mock_channels[channel].trans_count = trans_count;
+    if (trigger)
+    {
+        mock_trigger(channel);
+    }
+}
+
+void dma_channel_start(uint channel)
+{
+    mock_trigger(channel);
+}
+
+void dma_start_channel_mask(uint32_t chan_mask)
+{
+    for (uint channel = 0; channel < NUM_DMA_CHANNELS; channel++)
+    {
+        if (chan_mask & (1u << channel))
+        {
+            mock_trigger(channel);
+        }
+    }
+}
+
+bool dma_channel_is_busy(uint channel)
+{
+    return mock_channels[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel)
+{
+    while (mock_channels[channel].busy)
+    {
+        dma_mock::mock_dma_step();
+    }
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled)
+{
+    mock_channels[channel].irq_enabled[0] = enabled;
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled)
+{
+    mock_channels[channel].irq_enabled[1] = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel)
+{
+    return mock_channels[channel].irq_status[0];
+}
+
+bool dma_channel_get_irq1_status(uint channel)
+{
+    return mock_channels[channel].irq_status[1];
+}
+
+void dma_channel_acknowledge_irq0(uint channel)
+{
+    mock_channels[channel].irq_status[0] = false;
+}
+
+void dma_channel_acknowledge_irq1(uint channel)
+{
+    mock_channels[channel].irq_status[1] = false;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "hardware/dma.h"
+
+// Test helper functions for the mocked dma channels
+namespace dma_mock
+{
+    // unclaim all channels and drop pending transfers, irq handlers and counters
+    void mock_dma_reset();
+    // complete the transfer of the lowest busy channel and raise its irqs; false when all channels are idle
+    bool mock_dma_step();
+    // run until all channels are idle
+    void mock_dma_run();
+    // number of transfers (triggers) completed since the last reset
+    int mock_dma_transfers();
+}
@@ -0,0 +1,75 @@
+#include "gpio_mock.hpp"
+
+namespace
+{
+    const uint MOCK_GPIO_COUNT = 32;
+
+    uint32_t mock_gpio_state = 0xffffffff;
+    uint32_t mock_gpio_irq_events[MOCK_GPIO_COUNT];
+    gpio_irq_callback_t mock_gpio_callback = nullptr;
+}
+
+void gpio_init(uint /*gpio*/)
+{
+}
+
+void gpio_set_dir(uint /*gpio*/, bool /*out*/)
+{
+}
+
+void gpio_pull_up(uint gpio)
+{
+    mock_gpio_state |= 1u << gpio;
+}
+
+bool gpio_get(uint gpio)
+{
+    return (mock_gpio_state >> gpio) & 1;
+}
+
+uint32_t gpio_get_all()
+{
+    return mock_gpio_state;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback)
+{
+    // as on the board, there is one callback for all pins
+    mock_gpio_callback = callback;
+    if (enabled)
+    {
+        mock_gpio_irq_events[gpio] |= event_mask;
+    }
+    else
+    {
+        mock_gpio_irq_events[gpio] &= ~event_mask;
+    }
+}
+
+namespace gpio_mock
+{
+    void mock_gpio_reset()
+    {
+        mock_gpio_state = 0xffffffff;
+        mock_gpio_callback = nullptr;
+        for (uint gpio = 0; gpio < MOCK_GPIO_COUNT; gpio++)
+        {
+            mock_gpio_irq_events[gpio] = 0;
+        }
+    }
+
+    void mock_gpio_edge(uint gpio, bool level)
+    {
+        const bool was = (mock_gpio_state >> gpio) & 1;
+        mock_gpio_state = (mock_gpio_state & ~(1u << gpio)) | ((uint32_t)level << gpio);
+        if (was == level || !mock_gpio_callback)
+        {
+            return;
+        }
+        const uint32_t event = level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+        if (mock_gpio_irq_events[gpio] & event)
+        {
+            mock_gpio_callback(gpio, event);
+        }
+    }
+}
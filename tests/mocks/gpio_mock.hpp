@@ -0,0 +1,12 @@
+#pragma once
+
+#include "hardware/gpio.h"
+
+// Test helper functions for the mocked gpio pins
+namespace gpio_mock
+{
+    // pull all pins up and drop the irq callback and the enabled edges
+    void mock_gpio_reset();
+    // set the level of a pin and raise the gpio edge interrupt for it, when enabled
+    void mock_gpio_edge(uint gpio, bool level);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "pico/types.h"
+
+// Mock version of hardware/gpio.h for host testing
+// pin levels are set by the test (see gpio_mock.hpp); unconnected pins read as pulled up
+
+#define GPIO_IN false
+#define GPIO_OUT true
+
+enum gpio_irq_level
+{
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_pull_up(uint gpio);
+bool gpio_get(uint gpio);
+uint32_t gpio_get_all();
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "pico/types.h"
+
+// Mock version of hardware/irq.h for host testing
+
+#define DMA_IRQ_0 10
+#define DMA_IRQ_1 11
+
+typedef void (*irq_handler_t)();
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_set_enabled(uint num, bool enabled);
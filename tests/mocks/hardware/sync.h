@@ -0,0 +1,8 @@
+#pragma once
+
+#include "pico/types.h"
+
+// Mock version of hardware/sync.h for host testing
+
+uint32_t save_and_disable_interrupts();
+void restore_interrupts(uint32_t status);
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "pico/types.h"
+
+// Mock version of pico/platform.h for host testing
+// the core number is set by the test (see platform_mock.hpp)
+
+uint get_core_num();
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "pico/types.h"
+
+// Mock version of pico/time.h for host testing
+// the clock only moves when a test moves it (see time_mock.hpp)
+
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time();
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us);
+uint64_t to_us_since_boot(absolute_time_t t);
+uint64_t time_us_64();
+uint32_t time_us_32();
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Mock version of the pico sdk base types for host testing
+
+typedef unsigned int uint;
+
+#define __unused __attribute__((unused))
+#define __isr
+#define hard_assert(x) ((void)(x))
+
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+// Mock busy-wait hook; lets the mocked hardware make progress while the code under test spins
+void tight_loop_contents();
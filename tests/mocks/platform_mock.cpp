@@ -0,0 +1,19 @@
+#include "platform_mock.hpp"
+
+namespace
+{
+    uint mock_core = 0;
+}
+
+uint get_core_num()
+{
+    return mock_core;
+}
+
+namespace platform_mock
+{
+    void mock_core_set(uint core)
+    {
+        mock_core = core;
+    }
+}
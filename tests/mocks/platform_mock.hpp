@@ -0,0 +1,9 @@
+#pragma once
+
+#include "pico/platform.h"
+
+// Test helper functions for the mocked platform
+namespace platform_mock
+{
+    void mock_core_set(uint core);
+}
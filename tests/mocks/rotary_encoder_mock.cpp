@@ -2,43 +2,51 @@
 
 namespace rotary_encoder
 {
-    rotary_encoder rotary_encoders[NUM_ROTARY_ENCODERS];
-
-    int32_t rotary_encoder_fetch_counter(rotary_encoder *re)
+    // Test helper functions
+    void mock_set_encoder_delta(int encoder_index, int32_t delta)
     {
-        int32_t delta = re->counter;
-        re->counter = 0; // Reset counter after reading
-        return delta;
+        if (encoder_index >= 0 && encoder_index < NUM_ROTARY_ENCODERS)
+        {
+            rotary_encoders[encoder_index].counter = delta;
+        }
     }
 
-    uint8_t rotary_encoder_fetch_sw_state(rotary_encoder *re)
+    void mock_set_switch_state(int encoder_index, uint8_t state)
     {
-        return re->sw_state;
+        if (encoder_index >= 0 && encoder_index < NUM_ROTARY_ENCODERS)
+        {
+            rotary_encoders[encoder_index].sw_state = state;
+        }
     }
 
-    void rotary_encoders_init(void)
+    void mock_inject_a_b_sequence(int encoder_index, const uint8_t *a_b, int n)
     {
-        for (int i = 0; i < NUM_ROTARY_ENCODERS; i++)
+        const rotary_encoder *re = &rotary_encoders[encoder_index];
+        for (int i = 0; i < n; i++)
         {
-            rotary_encoders[i].counter = 0;
-            rotary_encoders[i].sw_state = ROTARY_ENCODER_SW_RELEASED;
+            gpio_mock::mock_gpio_edge(re->a, (a_b[i] >> 1) & 1);
+            gpio_mock::mock_gpio_edge(re->b, a_b[i] & 1);
         }
     }
 
-    // Test helper functions
-    void mock_set_encoder_delta(int encoder_index, int32_t delta)
+    void mock_inject_steps(int encoder_index, int32_t steps)
     {
-        if (encoder_index >= 0 && encoder_index < NUM_ROTARY_ENCODERS)
+        // gray code sequence of a clockwise rotation
+        static const uint8_t clockwise[4] = {0b00, 0b01, 0b11, 0b10};
+
+        const rotary_encoder *re = &rotary_encoders[encoder_index];
+        const uint8_t a_b_now = (gpio_get(re->a) << 1) | gpio_get(re->b);
+        int phase = 0;
+        while (clockwise[phase] != a_b_now)
         {
-            rotary_encoders[encoder_index].counter = delta;
+            phase++;
         }
-    }
 
-    void mock_set_switch_state(int encoder_index, uint8_t state)
-    {
-        if (encoder_index >= 0 && encoder_index < NUM_ROTARY_ENCODERS)
+        const int direction = steps >= 0 ? 1 : 3;
+        for (int32_t i = 0; i < (steps >= 0 ? steps : -steps); i++)
         {
-            rotary_encoders[encoder_index].sw_state = state;
+            phase = (phase + direction) & 3;
+            mock_inject_a_b_sequence(encoder_index, &clockwise[phase], 1);
         }
     }
-}
\ No newline at end of file
+}
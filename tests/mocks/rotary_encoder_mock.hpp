@@ -1,35 +1,17 @@
 #pragma once
 
-#include <cstdint>
+// the encoders are the real src/rotary_encoder.cpp, driven through the mocked gpio pins
+#include "gpio_mock.hpp"
+#include "rotary_encoder.hpp"
 
 namespace rotary_encoder
 {
-    typedef struct
-    {
-        uint8_t a;
-        uint8_t b;
-        uint8_t sw;
-
-        volatile uint8_t a_b_trail;
-        volatile int32_t counter;
-        volatile uint8_t sw_trail;
-        volatile uint8_t sw_state;
-    } rotary_encoder;
-
-    enum
-    {
-        ROTARY_ENCODER_SW_RELEASED = 0,
-        ROTARY_ENCODER_SW_PRESSED,
-    };
-
-#define NUM_ROTARY_ENCODERS 2
-    extern rotary_encoder rotary_encoders[NUM_ROTARY_ENCODERS];
-
-    int32_t rotary_encoder_fetch_counter(rotary_encoder *re);
-    uint8_t rotary_encoder_fetch_sw_state(rotary_encoder *re);
-    void rotary_encoders_init(void);
-
     // Test helper functions
     void mock_set_encoder_delta(int encoder_index, int32_t delta);
     void mock_set_switch_state(int encoder_index, uint8_t state);
-}
\ No newline at end of file
+
+    // drive the a/b pins of an encoder through `steps` quadrature steps (positive = clockwise)
+    void mock_inject_steps(int encoder_index, int32_t steps);
+    // inject a raw sequence of a/b states (a << 1 | b), one edge interrupt per changed pin
+    void mock_inject_a_b_sequence(int encoder_index, const uint8_t *a_b, int n);
+}
@@ -16,11 +16,17 @@ namespace screen
 
     typedef struct screen
     {
+        int64_t time_rasterise;
         int64_t time_gamma_correction;
         int64_t time_dithering;
         int64_t time_screen_to_led_colors;
         int64_t time_led_colors_to_bitplanes;
         int64_t time_wait_for_DMA;
+        int64_t time_pixel_pipeline; // wall time of gamma correction, dithering and remap, shared by both cores
+        int64_t time_tiles_core0;    // busy time of each core on the tiles above
+        int64_t time_tiles_core1;
+        int64_t power_estimate_mA; // estimated current of the last frame
+        int64_t power_limit;       // output scale of the current limiter, 256 when not limiting
     } scr_profile_t;
 
     extern volatile scr_profile_t scr_profile;
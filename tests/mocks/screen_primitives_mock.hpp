@@ -32,6 +32,22 @@ namespace screen
         }
     }
 
+    static inline void add_pixel(const int x, const int y, const ws2812::led_color_t c)
+    {
+        if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT)
+        {
+            ws2812::led_color_t *p = &(*scr_screen)[y][x];
+
+            const int r = p->r + c.r;
+            const int g = p->g + c.g;
+            const int b = p->b + c.b;
+
+            p->r = r > 255 ? 255 : r;
+            p->g = g > 255 ? 255 : g;
+            p->b = b > 255 ? 255 : b;
+        }
+    }
+
     static inline void draw_vertical_line(const int x, int y0, int y1, const ws2812::led_color_t c)
     {
         if (x < 0 || x >= SCREEN_WIDTH) return;
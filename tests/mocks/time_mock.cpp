@@ -0,0 +1,49 @@
+#include "time_mock.hpp"
+
+namespace
+{
+    uint64_t mock_now_us = 0;
+}
+
+absolute_time_t get_absolute_time()
+{
+    return mock_now_us;
+}
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to)
+{
+    return (int64_t)(to - from);
+}
+
+absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us)
+{
+    return t + us;
+}
+
+uint64_t to_us_since_boot(absolute_time_t t)
+{
+    return t;
+}
+
+uint64_t time_us_64()
+{
+    return mock_now_us;
+}
+
+uint32_t time_us_32()
+{
+    return (uint32_t)mock_now_us;
+}
+
+namespace time_mock
+{
+    void mock_time_set(uint64_t us)
+    {
+        mock_now_us = us;
+    }
+
+    void mock_time_advance(uint64_t us)
+    {
+        mock_now_us += us;
+    }
+}
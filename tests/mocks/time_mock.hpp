@@ -0,0 +1,10 @@
+#pragma once
+
+#include "pico/time.h"
+
+// Test helper functions for the mocked clock
+namespace time_mock
+{
+    void mock_time_set(uint64_t us);
+    void mock_time_advance(uint64_t us);
+}
@@ -0,0 +1,52 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include "line.hpp"
+#include "text.hpp"
+
+using namespace screen;
+
+static scr_frame_buffer_t fb;
+
+TEST_CASE("Blend policies", "[blend]")
+{
+    const ws2812::led_color_t grey = ws2812_pack_color(100, 100, 100);
+    const ws2812::led_color_t red = ws2812_pack_color(200, 0, 0);
+
+    for (int y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        for (int x = 0; x < SCREEN_WIDTH; x++)
+        {
+            fb[y][x] = grey;
+        }
+    }
+
+    SECTION("Alpha covers the full range from keeping to replacing the pixel")
+    {
+        blend_into(fb[0][0], pixel::px_load(red), blend_alpha(0));
+        blend_into(fb[0][1], pixel::px_load(red), blend_alpha(255));
+
+        REQUIRE(pixel::px_load(fb[0][0]) == pixel::px_load(grey));
+        REQUIRE(pixel::px_load(fb[0][1]) == pixel::px_load(red));
+    }
+
+    SECTION("Additive, multiply and max blending")
+    {
+        blend_into(fb[0][0], pixel::px_load(red), blend_add());
+        blend_into(fb[0][1], pixel::px_load(red), blend_multiply());
+        blend_into(fb[0][2], pixel::px_load(red), blend_max());
+
+        REQUIRE((fb[0][0].r == 255 && fb[0][0].g == 100));
+        REQUIRE((fb[0][1].r == 78 && fb[0][1].g == 0));
+        REQUIRE((fb[0][2].r == 200 && fb[0][2].g == 100));
+    }
+
+    SECTION("Primitives take the policy as a template argument")
+    {
+        draw_3x5_glyph(fb, font_3x5_glyph('#'), 0, 0, red, blend_add());
+        draw_line_aa(fb, 0, 10 * LINE_FP_ONE, 10 * LINE_FP_ONE, 10 * LINE_FP_ONE, red, blend_max());
+
+        REQUIRE((fb[1][1].r == 255 && fb[1][1].b == 100));
+        REQUIRE((fb[10][5].r == 200 && fb[10][5].b == 100));
+        REQUIRE(pixel::px_load(fb[11][5]) == pixel::px_load(grey));
+    }
+}
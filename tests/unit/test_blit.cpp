@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include "blit.hpp"
+#include "dma_mock.hpp"
+
+using namespace blit;
+
+static frame_buffer_t frame_a, frame_b;
+
+static bool rect_equals(const frame_buffer_t &fb, int x, int y, int w, int h, const ws2812::led_color_t c)
+{
+    for (int i = y; i < y + h; i++)
+    {
+        for (int j = x; j < x + w; j++)
+        {
+            if (memcmp(&fb[i][j], &c, sizeof(c)) != 0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE("DMA blit engine", "[blit]")
+{
+    const ws2812::led_color_t black = ws2812_pack_color(0, 0, 0);
+    const ws2812::led_color_t red = ws2812_pack_color(200, 0, 0);
+    const ws2812::led_color_t blue = ws2812_pack_color(0, 0, 200);
+    const int W = screen::SCREEN_WIDTH;
+    const int H = screen::SCREEN_HEIGHT;
+
+    dma_mock::mock_dma_reset();
+    blit_init();
+    memset(frame_a, 0x55, sizeof(frame_a));
+    memset(frame_b, 0, sizeof(frame_b));
+
+    SECTION("Commands run in the background until their fence is waited on")
+    {
+        const blit_fence_t fence = blit_fill(&frame_a, 0, 0, W, H, red);
+
+        REQUIRE_FALSE(blit_fence_reached(fence));
+        REQUIRE_FALSE(rect_equals(frame_a, 0, 0, W, H, red));
+
+        blit_wait(fence);
+        REQUIRE(blit_fence_reached(fence));
+        REQUIRE(rect_equals(frame_a, 0, 0, W, H, red));
+    }
+
+    SECTION("Full-width regions move in a single transfer")
+    {
+        blit_wait(blit_clear(&frame_a));
+
+        REQUIRE(dma_mock::mock_dma_transfers() == 1);
+        REQUIRE(rect_equals(frame_a, 0, 0, W, H, black));
+    }
+
+    SECTION("Rectangles are filled row by row and clipped to the screen")
+    {
+        blit_wait(blit_clear(&frame_a));
+        const int transfers = dma_mock::mock_dma_transfers();
+
+        blit_wait(blit_fill(&frame_a, -4, H - 3, 10, 8, blue));
+
+        REQUIRE(dma_mock::mock_dma_transfers() - transfers == 3);
+        REQUIRE(rect_equals(frame_a, 0, H - 3, 6, 3, blue));
+        REQUIRE(rect_equals(frame_a, 6, H - 3, W - 6, 3, black));
+        REQUIRE(rect_equals(frame_a, 0, 0, W, H - 3, black));
+    }
+
+    SECTION("Fully clipped commands do not queue anything")
+    {
+        const blit_fence_t fence = blit_fill(&frame_a, W, 0, 4, 4, red);
+
+        REQUIRE(blit_fence_reached(fence));
+        REQUIRE(dma_mock::mock_dma_transfers() == 0);
+    }
+
+    SECTION("Rectangular copies between frame buffers")
+    {
+        blit_fill(&frame_b, 0, 0, W, H, red);
+        blit_fill(&frame_b, 10, 5, 8, 4, blue);
+        blit_clear(&frame_a);
+        blit_copy(&frame_a, &frame_b, 8, 4, 12, 6);
+        blit_wait_all();
+
+        REQUIRE(rect_equals(frame_a, 10, 5, 8, 4, blue));
+        REQUIRE(rect_equals(frame_a, 8, 4, 2, 6, red));
+        REQUIRE(rect_equals(frame_a, 18, 4, 2, 6, red));
+        REQUIRE(rect_equals(frame_a, 0, 0, W, 4, black));
+        REQUIRE(rect_equals(frame_a, 0, 10, W, H - 10, black));
+    }
+
+    SECTION("Queue overflow blocks until a slot is free and keeps the order")
+    {
+        blit_fence_t fence = 0;
+        for (int i = 0; i < 3 * BLIT_QUEUE_SIZE + 1; i++)
+        {
+            fence = blit_fill(&frame_a, 0, 0, 2, H, (i & 1) ? red : blue);
+        }
+        blit_wait(fence);
+
+        REQUIRE(dma_mock::mock_dma_transfers() == (3 * BLIT_QUEUE_SIZE + 1) * H);
+        REQUIRE(rect_equals(frame_a, 0, 0, 2, H, blue));
+    }
+}
@@ -0,0 +1,69 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include "screen_primitives.hpp"
+
+using namespace screen;
+
+static scr_deep_frame_buffer_t deep;
+static scr_frame_buffer_t fb;
+
+TEST_CASE("Deep colour primitives", "[deep_primitives]")
+{
+    memset(deep, 0, sizeof(deep));
+    memset(fb, 0, sizeof(fb));
+
+    SECTION("Gradients step below one 8-bit level")
+    {
+        const scr_deep_color_t c0 = scr_deep_color(0, 0, 0);
+        const scr_deep_color_t c1 = scr_deep_color(4 * 257, 0, 65535);
+        draw_horizontal_gradient(deep, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, c0, c1);
+
+        REQUIRE(deep[5][0].r == 0);
+        REQUIRE(deep[5][SCREEN_WIDTH - 1].r == 4 * 257);
+        REQUIRE(deep[5][SCREEN_WIDTH - 1].b == 65535);
+        int distinct = 1;
+        for (int x = 1; x < SCREEN_WIDTH; x++)
+        {
+            REQUIRE(deep[5][x].r >= deep[5][x - 1].r);
+            distinct += deep[5][x].r != deep[5][x - 1].r;
+        }
+        // four 8-bit levels spread over every column
+        REQUIRE(distinct == SCREEN_WIDTH);
+    }
+
+    SECTION("Text lands where it does in 8-bit frame buffers")
+    {
+        const ws2812::led_color_t white = ws2812_pack_color(255, 255, 255);
+        draw_3x5_string(deep, "HI 42", 3, 7, scr_deep_color(white));
+        draw_3x5_string(fb, "HI 42", 3, 7, white);
+        draw_line(deep, 0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1, scr_deep_color(white));
+        draw_line(fb, 0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1, white);
+
+        for (int y = 0; y < SCREEN_HEIGHT; y++)
+        {
+            for (int x = 0; x < SCREEN_WIDTH; x++)
+            {
+                REQUIRE((deep[y][x].g == 65535) == (fb[y][x].g == 255));
+            }
+        }
+    }
+
+    SECTION("Indexed frame buffers take the same primitives")
+    {
+        static scr_indexed_frame_buffer_t indexed;
+        memset(indexed, 0, sizeof(indexed));
+        const ws2812::led_color_t white = ws2812_pack_color(255, 255, 255);
+        draw_rect(indexed, -2, 3, 9, 4, (uint8_t)5);
+        draw_rect(fb, -2, 3, 9, 4, white);
+        draw_line(indexed, 2, SCREEN_HEIGHT + 3, SCREEN_WIDTH - 7, 1, (uint8_t)5);
+        draw_line(fb, 2, SCREEN_HEIGHT + 3, SCREEN_WIDTH - 7, 1, white);
+
+        for (int y = 0; y < SCREEN_HEIGHT; y++)
+        {
+            for (int x = 0; x < SCREEN_WIDTH; x++)
+            {
+                REQUIRE((indexed[y][x] == 5) == (fb[y][x].g == 255));
+            }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include "display_list.hpp"
+
+using namespace screen;
+
+static scr_frame_buffer_t recorded, direct, sprite;
+
+TEST_CASE("Display list", "[display_list]")
+{
+    const ws2812::led_color_t red = ws2812_pack_color(200, 0, 0);
+    const ws2812::led_color_t green = ws2812_pack_color(0, 150, 0);
+    const ws2812::led_color_t blue = ws2812_pack_color(0, 0, 255);
+
+    dl_swap(); // start from an empty list
+    memset(recorded, 0x11, sizeof(recorded));
+    memset(direct, 0x11, sizeof(direct));
+    for (int y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        for (int x = 0; x < SCREEN_WIDTH; x++)
+        {
+            sprite[y][x] = ws2812_pack_color(x * 5, y * 7, 33);
+        }
+    }
+
+    SECTION("Rasterising the recorded commands matches drawing them directly")
+    {
+        REQUIRE(dl_rect(-3, 4, 12, 6, red));
+        REQUIRE(dl_line(0, 0, SCREEN_WIDTH + 5, SCREEN_HEIGHT - 3, green));
+        REQUIRE(dl_orb(20.5f, 12.25f, 4.0f, blue));
+        REQUIRE(dl_text("UPONG", SCREEN_WIDTH / 2, 20, green, FONT_3X5_CENTER));
+        REQUIRE(dl_number(1234, SCREEN_WIDTH - 1, 26, red, FONT_3X5_RIGHT));
+        REQUIRE(dl_blit(&sprite, 30, 2, 10, 40));
+        REQUIRE(dl_rect(31, 3, 2, 2, blue)); // drawn on top of the blit, in order
+
+        draw_rect(direct, -3, 4, 12, 6, red);
+        draw_line(direct, 0, 0, SCREEN_WIDTH + 5, SCREEN_HEIGHT - 3, green);
+        draw_orb(direct, 20.5f, 12.25f, 4.0f, blue);
+        draw_3x5_string(direct, "UPONG", SCREEN_WIDTH / 2, 20, green, FONT_3X5_CENTER);
+        draw_3x5_number(direct, 1234, SCREEN_WIDTH - 1, 26, red, FONT_3X5_RIGHT);
+        for (int y = 2; y < SCREEN_HEIGHT; y++)
+        {
+            memcpy(&direct[y][30], &sprite[y][30], 10 * sizeof(ws2812::led_color_t));
+        }
+        draw_rect(direct, 31, 3, 2, 2, blue);
+
+        const scr_display_list_t *dl = dl_swap();
+        REQUIRE(dl->count == 7);
+        REQUIRE_FALSE(dl->overflow);
+        dl_rasterise(dl, recorded);
+        REQUIRE(memcmp(recorded, direct, sizeof(recorded)) == 0);
+        REQUIRE(memcmp(&recorded[5][0], &red, sizeof(red)) == 0);
+    }
+
+    SECTION("Strings are copied into the text pool")
+    {
+        char str[] = "AB";
+        REQUIRE(dl_text(str, 0, 0, red));
+        str[0] = 'X';
+
+        draw_3x5_string(direct, "AB", 0, 0, red);
+        dl_rasterise(dl_swap(), recorded);
+        REQUIRE(memcmp(recorded, direct, sizeof(recorded)) == 0);
+    }
+
+    SECTION("A full command list drops further commands and flags the overflow")
+    {
+        for (int i = 0; i < DL_MAX_COMMANDS; i++)
+        {
+            REQUIRE(dl_rect(i % SCREEN_WIDTH, 0, 1, 1, red));
+        }
+        REQUIRE_FALSE(scr_display_list->overflow);
+        REQUIRE_FALSE(dl_number(7, 0, 10, blue));
+        REQUIRE_FALSE(dl_text("A", 0, 10, blue));
+        REQUIRE(scr_display_list->overflow);
+
+        const scr_display_list_t *dl = dl_swap();
+        REQUIRE(dl->count == DL_MAX_COMMANDS);
+        REQUIRE(dl->overflow);
+        REQUIRE(dl->text_used == 0);
+
+        // the list recorded next starts empty
+        REQUIRE(scr_display_list->count == 0);
+        REQUIRE_FALSE(scr_display_list->overflow);
+    }
+
+    SECTION("A full text pool drops the string and flags the overflow")
+    {
+        char long_str[DL_TEXT_POOL_SIZE];
+        memset(long_str, 'A', sizeof(long_str) - 1);
+        long_str[DL_TEXT_POOL_SIZE - 1] = 0;
+        REQUIRE(dl_text(long_str, 0, 0, red)); // exactly fills the pool with its terminator
+        REQUIRE(scr_display_list->text_used == DL_TEXT_POOL_SIZE);
+
+        REQUIRE_FALSE(dl_text("", 0, 0, red));
+        REQUIRE(scr_display_list->overflow);
+        REQUIRE(scr_display_list->count == 1);
+
+        // commands without text still fit
+        REQUIRE(dl_number(42, 0, 10, red));
+        REQUIRE(scr_display_list->count == 2);
+        dl_swap();
+    }
+}
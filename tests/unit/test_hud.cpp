@@ -0,0 +1,34 @@
+#include <catch2/catch_test_macros.hpp>
+#include "hud.hpp"
+
+using namespace hud;
+
+TEST_CASE("Performance hud", "[hud]")
+{
+    SECTION("A long press toggles once, a short one never")
+    {
+        hud_switch_t sw = {};
+        REQUIRE_FALSE(hud_switch_update(sw, true, 1000));
+        REQUIRE_FALSE(hud_switch_update(sw, true, 1000 + HUD_LONG_PRESS_US / 2));
+        REQUIRE_FALSE(hud_switch_update(sw, false, 1000 + HUD_LONG_PRESS_US / 2 + 1));
+
+        REQUIRE_FALSE(hud_switch_update(sw, true, 2000000));
+        REQUIRE_FALSE(hud_switch_update(sw, true, 2000000 + HUD_LONG_PRESS_US - 1));
+        REQUIRE(hud_switch_update(sw, true, 2000000 + HUD_LONG_PRESS_US));
+        // held on: no second toggle until released
+        REQUIRE_FALSE(hud_switch_update(sw, true, 2000000 + 3 * HUD_LONG_PRESS_US));
+        REQUIRE_FALSE(hud_switch_update(sw, false, 2000000 + 3 * HUD_LONG_PRESS_US));
+
+        REQUIRE_FALSE(hud_switch_update(sw, true, 5000000));
+        REQUIRE(hud_switch_update(sw, true, 5000000 + HUD_LONG_PRESS_US));
+    }
+
+    SECTION("Bars scale to the refresh period")
+    {
+        REQUIRE(hud_bar_length(0, 16000) == 0);
+        REQUIRE(hud_bar_length(1, 16000) == 1);
+        REQUIRE(hud_bar_length(8000, 16000) == HUD_BAR_WIDTH / 2);
+        REQUIRE(hud_bar_length(16000, 16000) == HUD_BAR_WIDTH);
+        REQUIRE(hud_bar_length(40000, 16000) == HUD_BAR_WIDTH);
+    }
+}
@@ -0,0 +1,110 @@
+#include <catch2/catch_test_macros.hpp>
+#include "latency.hpp"
+#include "time_mock.hpp"
+
+using namespace latency;
+using namespace time_mock;
+
+// one edge through the pipeline: input at t, consumed, picked up and presented after the given delays
+static void synthetic_frame(const uint32_t generation, const uint64_t consume_us, const uint64_t pickup_us, const uint64_t dma_us, const uint64_t latch_us)
+{
+    latency_input();
+    mock_time_advance(consume_us);
+    latency_consume(generation);
+    mock_time_advance(pickup_us);
+    latency_pickup(generation);
+    const absolute_time_t dma_done = delayed_by_us(get_absolute_time(), dma_us);
+    mock_time_advance(dma_us + latch_us);
+    latency_present(generation, dma_done, get_absolute_time());
+}
+
+TEST_CASE("Input to photon latency", "[latency]")
+{
+    latency_reset();
+    mock_time_set(1000000);
+
+    SECTION("A sample is split into its stages")
+    {
+        synthetic_frame(7, 3000, 5000, 7680, 80);
+
+        const latency_stats_t stats = latency_stats();
+        REQUIRE(stats.samples == 1);
+        REQUIRE(stats.min_us == 15760);
+        REQUIRE(stats.max_us == 15760);
+        REQUIRE(stats.mean_us == 15760);
+        REQUIRE(stats.stage_mean_us[LATENCY_STAGE_CONSUME] == 3000);
+        REQUIRE(stats.stage_mean_us[LATENCY_STAGE_PICKUP] == 5000);
+        REQUIRE(stats.stage_mean_us[LATENCY_STAGE_DMA] == 7680);
+        REQUIRE(stats.stage_mean_us[LATENCY_STAGE_LATCH] == 80);
+        REQUIRE(latency_histogram()[15760 / LATENCY_BIN_US] == 1);
+    }
+
+    SECTION("Edges are not sampled while one is followed")
+    {
+        latency_input();
+        mock_time_advance(1000);
+        latency_input(); // ignored
+        mock_time_advance(1000);
+        latency_consume(3);
+        latency_pickup(3);
+        latency_present(3, get_absolute_time(), get_absolute_time());
+
+        REQUIRE(latency_stats().samples == 1);
+        REQUIRE(latency_stats().max_us == 2000);
+    }
+
+    SECTION("Older frames do not end the probe, an overwritten frame is carried by the next")
+    {
+        latency_input();
+        latency_consume(10);
+        mock_time_advance(1000);
+        latency_pickup(9); // still the previous frame
+        latency_pickup(11); // frame 10 was swapped over before core1 took it
+        mock_time_advance(1000);
+        latency_present(9, get_absolute_time(), get_absolute_time());
+        REQUIRE(latency_stats().samples == 0);
+
+        mock_time_advance(1000);
+        latency_present(11, get_absolute_time(), get_absolute_time());
+        REQUIRE(latency_stats().samples == 1);
+        REQUIRE(latency_stats().max_us == 3000);
+    }
+
+    SECTION("Generations wrap")
+    {
+        synthetic_frame(0xffffffff, 100, 100, 100, 100);
+        latency_input();
+        latency_consume(0xffffffff);
+        latency_pickup(2);
+        latency_present(2, get_absolute_time(), get_absolute_time());
+        REQUIRE(latency_stats().samples == 2);
+    }
+
+    SECTION("The distribution of a session")
+    {
+        // 100 edges at evenly spread phases of a 60 Hz refresh: 1 to 100 refresh steps of 166 us
+        for (uint32_t i = 1; i <= 100; i++)
+        {
+            synthetic_frame(i, 166 * i, 0, 7680, 80);
+            mock_time_advance(50000);
+        }
+
+        const latency_stats_t stats = latency_stats();
+        REQUIRE(stats.samples == 100);
+        REQUIRE(stats.min_us == 166 + 7760);
+        REQUIRE(stats.max_us == 16600 + 7760);
+        REQUIRE(stats.mean_us == 166 * 101 / 2 + 7760);
+        // percentiles are bin upper edges: the sample of rank n lies in the bin below them
+        REQUIRE(stats.p50_us == ((166 * 50 + 7760) / LATENCY_BIN_US + 1) * LATENCY_BIN_US);
+        REQUIRE(stats.p90_us == ((166 * 90 + 7760) / LATENCY_BIN_US + 1) * LATENCY_BIN_US);
+        REQUIRE(stats.p99_us == ((166 * 99 + 7760) / LATENCY_BIN_US + 1) * LATENCY_BIN_US);
+    }
+
+    SECTION("Latencies past the histogram land in its last bin")
+    {
+        synthetic_frame(1, 1000000, 0, 0, 0);
+        REQUIRE(latency_histogram()[LATENCY_BINS - 1] == 1);
+        REQUIRE(latency_stats().p99_us == LATENCY_BINS * LATENCY_BIN_US);
+        REQUIRE(latency_stats().max_us == 1000000);
+    }
+}
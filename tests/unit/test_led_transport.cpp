@@ -0,0 +1,78 @@
+#include <catch2/catch_test_macros.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "led_transport.hpp"
+#include "time_mock.hpp"
+
+using namespace led_transport;
+
+TEST_CASE("Host sink transport", "[led_transport]")
+{
+    REQUIRE(transport_init());
+    ws2812::led_color_t(&leds)[ws2812::NMB_STRIPS][ws2812::LEDS_PER_STRIP] = *ws2812::led_colors;
+    memset(leds, 0, sizeof(leds));
+
+    SECTION("Submitted frames are captured")
+    {
+        leds[2][17] = ws2812_pack_color(1, 2, 3);
+
+        transport_begin_frame();
+        transport_end_frame();
+        transport_submit();
+        transport_wait();
+
+        REQUIRE(transport_sink.frames_submitted == 1);
+        REQUIRE(memcmp(transport_sink.led_colors, leds, sizeof(leds)) == 0);
+
+        // the captured frame does not follow later writes
+        leds[2][17] = ws2812_pack_color(4, 5, 6);
+        REQUIRE(transport_sink.led_colors[2][17].r == 1);
+
+        // a static frame is sent again as it was
+        transport_resubmit();
+        REQUIRE(transport_sink.frames_submitted == 2);
+        REQUIRE(transport_sink.led_colors[2][17].r == 1);
+    }
+
+    SECTION("Frames are appended to the sink file")
+    {
+        char path[] = "/tmp/upong_sink_XXXXXX";
+        const int fd = mkstemp(path);
+        REQUIRE(fd >= 0);
+        close(fd);
+        REQUIRE(transport_sink_open(path));
+
+        transport_submit();
+        transport_submit();
+        REQUIRE(transport_sink_open(nullptr));
+
+        FILE *f = fopen(path, "rb");
+        REQUIRE(f != nullptr);
+        fseek(f, 0, SEEK_END);
+        REQUIRE(ftell(f) == (long)(2 * sizeof(leds)));
+        fclose(f);
+        remove(path);
+    }
+
+    SECTION("Every submitted frame is latched in order with its time")
+    {
+        const uint32_t frames = transport_present().frames;
+
+        time_mock::mock_time_set(1000);
+        transport_submit();
+        transport_present_t present = transport_present();
+        REQUIRE(present.frames == frames + 1);
+        REQUIRE(present.dma_done == 1000);
+        REQUIRE(present.latched == 1000);
+
+        time_mock::mock_time_advance(16667);
+        transport_resubmit();
+        present = transport_present();
+        REQUIRE(present.frames == frames + 2);
+        REQUIRE(present.latched == 17667);
+    }
+
+    REQUIRE(transport_timing().frame_us == 0);
+}
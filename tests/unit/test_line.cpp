@@ -0,0 +1,126 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include "line.hpp"
+
+using namespace screen;
+
+// the frame buffer is fenced by guard rows to catch writes outside of it
+static struct
+{
+    ws2812::led_color_t guard_before[SCREEN_WIDTH];
+    scr_frame_buffer_t fb;
+    ws2812::led_color_t guard_after[SCREEN_WIDTH];
+} frame;
+
+static int count_lit(const scr_frame_buffer_t &fb)
+{
+    int n = 0;
+    for (int y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        for (int x = 0; x < SCREEN_WIDTH; x++)
+        {
+            n += (fb[y][x].r != 0);
+        }
+    }
+    return n;
+}
+
+static bool guards_intact()
+{
+    for (int i = 0; i < SCREEN_WIDTH; i++)
+    {
+        if (frame.guard_before[i].r || frame.guard_after[i].r)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Integer line clipping and rasterisation", "[line]")
+{
+    const ws2812::led_color_t red = ws2812_pack_color(200, 0, 0);
+    const int W = SCREEN_WIDTH;
+    const int H = SCREEN_HEIGHT;
+
+    memset(&frame, 0, sizeof(frame));
+
+    SECTION("Visible segments are left untouched by clipping")
+    {
+        int x0 = 1, y0 = 2, x1 = W - 2, y1 = H - 3;
+        REQUIRE(clip_line(x0, y0, x1, y1));
+        REQUIRE((x0 == 1 && y0 == 2 && x1 == W - 2 && y1 == H - 3));
+    }
+
+    SECTION("Segments are clipped to the screen edges")
+    {
+        int x0 = -10, y0 = -10, x1 = W + 10, y1 = W + 10;
+        REQUIRE(clip_line(x0, y0, x1, y1));
+        REQUIRE((x0 == 0 && y0 == 0));
+        REQUIRE((x1 == H - 1 && y1 == H - 1));
+    }
+
+    SECTION("Segments outside of the screen are rejected")
+    {
+        int x0 = -10, y0 = 3, x1 = -1, y1 = 40;
+        REQUIRE_FALSE(clip_line(x0, y0, x1, y1));
+
+        x0 = -20, y0 = 5, x1 = 5, y1 = -20;
+        REQUIRE_FALSE(clip_line(x0, y0, x1, y1));
+    }
+
+    SECTION("Clipped lines stay on screen and keep their end points")
+    {
+        draw_clipped_line(frame.fb, -30, -7, W + 25, H + 4, red);
+        draw_clipped_line(frame.fb, W + 3, -2, -5, H + 1, red);
+
+        REQUIRE(guards_intact());
+        REQUIRE(frame.fb[0][0].r == 0);
+        REQUIRE(count_lit(frame.fb) > W);
+    }
+
+    SECTION("Diagonals light exactly one pixel per step")
+    {
+        draw_clipped_line(frame.fb, 0, 0, H - 1, H - 1, red);
+
+        REQUIRE(count_lit(frame.fb) == H);
+        for (int i = 0; i < H; i++)
+        {
+            REQUIRE(frame.fb[i][i].r == 200);
+        }
+    }
+}
+
+TEST_CASE("Anti-aliased lines", "[line]")
+{
+    const ws2812::led_color_t red = ws2812_pack_color(200, 0, 0);
+
+    memset(&frame, 0, sizeof(frame));
+
+    SECTION("Lines through pixel centres are drawn at full intensity")
+    {
+        draw_line_aa(frame.fb, 2 * LINE_FP_ONE, 4 * LINE_FP_ONE, 12 * LINE_FP_ONE, 4 * LINE_FP_ONE, red);
+
+        REQUIRE(count_lit(frame.fb) == 11);
+        REQUIRE(frame.fb[4][2].r == 200);
+        REQUIRE(frame.fb[4][12].r == 200);
+    }
+
+    SECTION("Coverage is split between the two straddled pixels")
+    {
+        draw_line_aa(frame.fb, 0, 4 * LINE_FP_ONE + LINE_FP_ONE / 4, 10 * LINE_FP_ONE, 4 * LINE_FP_ONE + LINE_FP_ONE / 4, red);
+
+        REQUIRE(frame.fb[4][5].r == 150);
+        REQUIRE(frame.fb[5][5].r == 50);
+        REQUIRE(frame.fb[4][5].r + frame.fb[5][5].r == red.r);
+    }
+
+    SECTION("Lines crossing the edges are clipped")
+    {
+        draw_line_aa(frame.fb, -40 * LINE_FP_ONE, -LINE_FP_ONE / 2, 80 * LINE_FP_ONE, (SCREEN_HEIGHT + 3) * LINE_FP_ONE, red);
+        draw_line_aa(frame.fb, 3 * LINE_FP_ONE, -50 * LINE_FP_ONE, 5 * LINE_FP_ONE, 70 * LINE_FP_ONE, red);
+
+        REQUIRE(guards_intact());
+        REQUIRE(count_lit(frame.fb) > 0);
+    }
+}
@@ -0,0 +1,86 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "particles.hpp"
+
+using namespace particles;
+
+TEST_CASE("Particle pool", "[particles]")
+{
+    const ws2812::led_color_t red = ws2812_pack_color(200, 0, 0);
+    const ws2812::led_color_t green = ws2812_pack_color(0, 200, 0);
+
+    screen::scr_clear_screen();
+
+    SECTION("Emit respects the fixed capacity")
+    {
+        CParticlePool<8> pool;
+        for (int i = 0; i < 8; i++)
+        {
+            REQUIRE(pool.emit(0, 0, 0, 0, 1, red));
+        }
+        REQUIRE_FALSE(pool.emit(0, 0, 0, 0, 1, red));
+        REQUIRE(pool.size() == pool.capacity());
+    }
+
+    SECTION("Particles move and expire after their lifetime")
+    {
+        CParticlePool<8> pool;
+        pool.emit(10, 10, 4, -2, 1.0f, red);
+        pool.emit(10, 10, 0, 0, 0.25f, green);
+
+        pool.update(0.5f);
+        REQUIRE(pool.size() == 1);
+
+        pool.draw();
+        REQUIRE((*screen::scr_screen)[9][12].r == 100);
+        REQUIRE((*screen::scr_screen)[10][10].g == 0);
+
+        pool.update(0.5f);
+        REQUIRE(pool.size() == 0);
+    }
+
+    SECTION("Overlapping particles add and saturate")
+    {
+        CParticlePool<8> pool;
+        pool.emit(5, 5, 0, 0, 1, red);
+        pool.emit(5, 5, 0, 0, 1, red);
+        pool.emit(5, 5, 0, 0, 1, green);
+        pool.draw();
+
+        REQUIRE((*screen::scr_screen)[5][5].r == 255);
+        REQUIRE((*screen::scr_screen)[5][5].g == 200);
+    }
+
+    SECTION("Particles just past the left or top edge are not drawn")
+    {
+        CParticlePool<8> pool;
+        pool.emit(-0.5f, 3.25f, 0, 0, 1, red);
+        pool.emit(7.5f, -0.25f, 0, 0, 1, green);
+        pool.emit(-0.75f, -0.75f, 0, 0, 1, red);
+        pool.draw();
+
+        for (int y = 0; y < screen::SCREEN_HEIGHT; y++)
+        {
+            REQUIRE((*screen::scr_screen)[y][0].r == 0);
+        }
+        for (int x = 0; x < screen::SCREEN_WIDTH; x++)
+        {
+            REQUIRE((*screen::scr_screen)[0][x].g == 0);
+        }
+    }
+
+    SECTION("Burst emits up to the remaining capacity")
+    {
+        CParticlePool<384> pool;
+        REQUIRE(pool.burst(24, 16, 300, 20, 1, red) == 300);
+        REQUIRE(pool.burst(24, 16, 300, 20, 1, red) == 84);
+
+        // off screen particles are clipped by add_pixel
+        for (int i = 0; i < 100; i++)
+        {
+            pool.update(0.009f);
+            pool.draw();
+        }
+        REQUIRE(pool.size() == 384);
+    }
+}
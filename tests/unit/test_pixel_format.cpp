@@ -0,0 +1,57 @@
+#include <catch2/catch_test_macros.hpp>
+#include "ws2812.hpp"
+
+using namespace ws2812;
+
+// the byte sent at a wire position of an encoded word
+static uint8_t wire_byte(const uint32_t word, const int position)
+{
+    return (word >> led_wire_shift(position)) & 0xff;
+}
+
+TEST_CASE("Pixel formats encode wire words", "[pixel_format]")
+{
+    const led_color_t c = ws2812_pack_color(200, 100, 50);
+
+    SECTION("The native grb format leaves led_color_t unchanged")
+    {
+        const uint32_t word = led_format_grb::encode(c);
+        REQUIRE(wire_byte(word, 0) == 100);
+        REQUIRE(wire_byte(word, 1) == 200);
+        REQUIRE(wire_byte(word, 2) == 50);
+    }
+
+    SECTION("Channels go out in the order of the format")
+    {
+        const uint32_t rgb = led_format_rgb::encode(c);
+        REQUIRE(wire_byte(rgb, 0) == 200);
+        REQUIRE(wire_byte(rgb, 1) == 100);
+        REQUIRE(wire_byte(rgb, 2) == 50);
+
+        const uint32_t brg = led_format_brg::encode(c);
+        REQUIRE(wire_byte(brg, 0) == 50);
+        REQUIRE(wire_byte(brg, 1) == 200);
+        REQUIRE(wire_byte(brg, 2) == 100);
+    }
+
+    SECTION("Rgbw formats move the common part to the white channel")
+    {
+        const uint32_t word = led_format_grbw::encode(c);
+        REQUIRE(wire_byte(word, 0) == 50);
+        REQUIRE(wire_byte(word, 1) == 150);
+        REQUIRE(wire_byte(word, 2) == 0);
+        REQUIRE(wire_byte(word, 3) == 50);
+
+        const uint32_t white = led_format_rgbw::encode(ws2812_pack_color(255, 255, 255));
+        REQUIRE(white == (255u << led_wire_shift(3)));
+    }
+
+    SECTION("Strip formats are dispatched to the matching encoder")
+    {
+        int channels = 0;
+        with_led_format(LED_FORMAT_RGBW, [&](auto format)
+                        { channels = decltype(format)::CHANNELS; });
+        REQUIRE(channels == 4);
+        REQUIRE(led_format_channels(STRIP_FORMATS[0]) == 3);
+    }
+}
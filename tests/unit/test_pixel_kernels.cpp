@@ -0,0 +1,171 @@
+#include <catch2/catch_test_macros.hpp>
+#include <stdlib.h>
+#include "pixel_kernels.hpp"
+
+using namespace pixel;
+
+static uint8_t byte_of(const px_t p, const int i)
+{
+    return (p >> (8 * i)) & 0xff;
+}
+
+TEST_CASE("Packed pixel kernels match per-channel arithmetic", "[pixel_kernels]")
+{
+    srand(1234);
+
+    for (int n = 0; n < 2000; n++)
+    {
+        const px_t a = ((px_t)rand() << 16) ^ (px_t)rand();
+        const px_t b = ((px_t)rand() << 16) ^ (px_t)rand();
+        const uint32_t w = rand() % 257;
+
+        const px_t add = px_add_sat(a, b);
+        const px_t half = px_halving_add(a, b);
+        const px_t mix = px_mix(a, b, 256 - w, w);
+        const px_t max = px_max(a, b);
+        const px_t mul = px_multiply(a, b);
+
+        for (int i = 0; i < 4; i++)
+        {
+            const int sum = byte_of(a, i) + byte_of(b, i);
+            REQUIRE(byte_of(add, i) == (sum > 255 ? 255 : sum));
+            REQUIRE(byte_of(half, i) == sum >> 1);
+            REQUIRE(byte_of(mix, i) == ((byte_of(a, i) * (256 - w) + byte_of(b, i) * w) >> 8));
+            REQUIRE(byte_of(max, i) == (byte_of(a, i) > byte_of(b, i) ? byte_of(a, i) : byte_of(b, i)));
+            REQUIRE(byte_of(mul, i) == (byte_of(a, i) * byte_of(b, i) * 2 + 255) / 510);
+        }
+    }
+}
+
+TEST_CASE("Swar max matches the per-byte maximum", "[pixel_kernels]")
+{
+    // bytes around the top bit, where the borrow-isolated compare changes over, in every position
+    const uint8_t edges[] = {0x00, 0x01, 0x7e, 0x7f, 0x80, 0x81, 0xfe, 0xff};
+    for (const uint8_t x : edges)
+    {
+        for (const uint8_t y : edges)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                const px_t a = (px_t)x << (8 * i) | (px_t)y << (8 * ((i + 1) & 3));
+                const px_t b = (px_t)y << (8 * i) | (px_t)x << (8 * ((i + 1) & 3));
+                const px_t max = px_max(a, b);
+                REQUIRE(byte_of(max, i) == (x > y ? x : y));
+                REQUIRE(byte_of(max, (i + 1) & 3) == (x > y ? x : y));
+            }
+        }
+    }
+
+    srand(4321);
+    for (int n = 0; n < 10000; n++)
+    {
+        const px_t a = ((px_t)rand() << 16) ^ (px_t)rand();
+        const px_t b = ((px_t)rand() << 16) ^ (px_t)rand();
+        px_t expected = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            expected |= (px_t)(byte_of(a, i) > byte_of(b, i) ? byte_of(a, i) : byte_of(b, i)) << (8 * i);
+        }
+        REQUIRE(px_max(a, b) == expected);
+    }
+}
+
+TEST_CASE("Pixel row kernels", "[pixel_kernels]")
+{
+    ws2812::led_color_t row[4], err[4], out[4];
+    const ws2812::led_color_t c = ws2812_pack_color(200, 100, 51);
+
+    SECTION("Mixing a row gives the same result as mixing each pixel")
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            row[i] = ws2812_pack_color(10 * i, 255 - i, 128);
+        }
+        px_t expected[4];
+        for (int i = 0; i < 4; i++)
+        {
+            expected[i] = px_mix(px_load(row[i]), px_load(c), 255 - 77, 77);
+        }
+
+        px_mix_row(row, 4, c, 255 - 77, 77);
+
+        for (int i = 0; i < 4; i++)
+        {
+            REQUIRE(px_load(row[i]) == expected[i]);
+        }
+    }
+
+    SECTION("Dithering alternates between the two nearest 7-bit levels")
+    {
+        const ws2812::led_color_t src = ws2812_pack_color(3, 4, 255);
+        const px_t zero = 0;
+        px_store(err[0], zero);
+
+        px_dither_row(&src, err, out, 1);
+        REQUIRE(out[0].r == 1);
+        REQUIRE(out[0].g == 2);
+        REQUIRE(out[0].b == 127);
+
+        px_dither_row(&src, err, out, 1);
+        REQUIRE(out[0].r == 2);
+        REQUIRE(out[0].g == 2);
+        REQUIRE(out[0].b == 128);
+    }
+}
+
+TEST_CASE("Ordered dithering", "[pixel_kernels]")
+{
+    SECTION("Every pixel meets each threshold once in 64 frames")
+    {
+        for (int y = 0; y < 8; y++)
+        {
+            for (int x = 0; x < 8; x++)
+            {
+                bool seen[256] = {};
+                for (uint32_t frame = 0; frame < 64; frame++)
+                {
+                    const uint32_t t = px_bayer_threshold(x, y, frame);
+                    REQUIRE(t % 4 == 2);
+                    REQUIRE_FALSE(seen[t]);
+                    seen[t] = true;
+                }
+            }
+        }
+    }
+
+    SECTION("Over 64 frames the levels average to the 8.8 input")
+    {
+        for (uint32_t level = 0; level < 255 * 256; level += 37)
+        {
+            uint32_t sum = 0;
+            for (uint32_t frame = 0; frame < 64; frame++)
+            {
+                sum += px_ordered_level(level, px_bayer_threshold(5, 3, frame));
+            }
+            // the average is the level rounded to 1/64
+            REQUIRE(sum == (level + 2) / 4);
+        }
+    }
+
+    SECTION("The thresholds of one frame spread a level over the tile")
+    {
+        const uint32_t level = 100 * 256 + 64; // a quarter above 100
+        int up = 0;
+        for (int y = 0; y < 8; y++)
+        {
+            for (int x = 0; x < 8; x++)
+            {
+                const uint8_t v = px_ordered_level(level, px_bayer_threshold(x, y, 7));
+                REQUIRE((v == 100 || v == 101));
+                up += v == 101;
+            }
+        }
+        REQUIRE(up == 16);
+    }
+
+    SECTION("Levels are clamped to 8 bits")
+    {
+        REQUIRE(px_ordered_level(255 * 256 + 255, 254) == 255);
+        REQUIRE(px_ordered_level(0, 254) == 0);
+    }
+}
@@ -0,0 +1,119 @@
+#include <catch2/catch_test_macros.hpp>
+#include "latency.hpp"
+#include "quadrature.hpp"
+#include "rotary_encoder_mock.hpp"
+
+using namespace rotary_encoder;
+
+TEST_CASE("Quadrature decoder table", "[rotary_encoder]")
+{
+    SECTION("Clockwise gray code sequence counts up")
+    {
+        volatile uint8_t trail = 0b00;
+        int32_t counter = 0;
+        const uint8_t sequence[] = {0b01, 0b11, 0b10, 0b00, 0b01, 0b11, 0b10, 0b00};
+        for (auto a_b : sequence)
+        {
+            counter += quadrature::quadrature_step(&trail, a_b);
+        }
+        REQUIRE(counter == 8);
+    }
+
+    SECTION("Counter clockwise gray code sequence counts down")
+    {
+        volatile uint8_t trail = 0b00;
+        int32_t counter = 0;
+        const uint8_t sequence[] = {0b10, 0b11, 0b01, 0b00};
+        for (auto a_b : sequence)
+        {
+            counter += quadrature::quadrature_step(&trail, a_b);
+        }
+        REQUIRE(counter == -4);
+    }
+
+    SECTION("Repeated and invalid transitions are ignored")
+    {
+        for (uint8_t prev = 0; prev < 4; prev++)
+        {
+            volatile uint8_t trail = prev;
+            REQUIRE(quadrature::quadrature_step(&trail, prev) == 0);
+            trail = prev;
+            REQUIRE(quadrature::quadrature_step(&trail, prev ^ 0b11) == 0);
+        }
+    }
+}
+
+TEST_CASE("Rotary encoder isr dispatch", "[rotary_encoder]")
+{
+    gpio_mock::mock_gpio_reset();
+    rotary_encoders_init();
+
+    SECTION("Steps are routed to the encoder owning the pin")
+    {
+        mock_inject_steps(0, 5);
+        mock_inject_steps(1, -3);
+
+        REQUIRE(rotary_encoder_fetch_counter(&rotary_encoders[0]) == 5);
+        REQUIRE(rotary_encoder_fetch_counter(&rotary_encoders[1]) == -3);
+        REQUIRE(rotary_encoder_fetch_counter(&rotary_encoders[0]) == 0);
+    }
+
+    SECTION("High rate interleaved edges on all encoders")
+    {
+        const int32_t steps = 100000;
+        for (int32_t i = 0; i < steps; i++)
+        {
+            for (int e = 0; e < NUM_ROTARY_ENCODERS; e++)
+            {
+                mock_inject_steps(e, (e & 1) ? -1 : 1);
+            }
+        }
+
+        for (int e = 0; e < NUM_ROTARY_ENCODERS; e++)
+        {
+            REQUIRE(rotary_encoder_fetch_counter(&rotary_encoders[e]) == ((e & 1) ? -steps : steps));
+        }
+    }
+
+    SECTION("Contact bounce on one pin does not drift the counter")
+    {
+        // a bounces 11 -> 01 -> 11 -> 01 before settling
+        const uint8_t bounce[] = {0b01, 0b11, 0b01, 0b11, 0b01};
+        mock_inject_a_b_sequence(0, bounce, sizeof(bounce));
+
+        REQUIRE(rotary_encoder_fetch_counter(&rotary_encoders[0]) == -1);
+    }
+
+    SECTION("Switch edges update the switch state")
+    {
+        gpio_mock::mock_gpio_edge(rotary_encoders[1].sw, false);
+        REQUIRE(rotary_encoder_fetch_sw_state(&rotary_encoders[1]) == ROTARY_ENCODER_SW_PRESSED);
+        REQUIRE(rotary_encoder_fetch_sw_state(&rotary_encoders[0]) == ROTARY_ENCODER_SW_RELEASED);
+
+        gpio_mock::mock_gpio_edge(rotary_encoders[1].sw, true);
+        REQUIRE(rotary_encoder_fetch_sw_state(&rotary_encoders[1]) == ROTARY_ENCODER_SW_RELEASED);
+    }
+
+    SECTION("Edges on unrelated pins are ignored")
+    {
+        gpio_mock::mock_gpio_edge(2, false);
+        gpio_mock::mock_gpio_edge(2, true);
+
+        for (int e = 0; e < NUM_ROTARY_ENCODERS; e++)
+        {
+            REQUIRE(rotary_encoder_fetch_counter(&rotary_encoders[e]) == 0);
+        }
+    }
+
+    SECTION("Steps start an input to photon latency probe")
+    {
+        latency::latency_reset();
+        mock_inject_steps(0, 1);
+        latency::latency_consume(1);
+        latency::latency_pickup(1);
+        latency::latency_present(1, get_absolute_time(), get_absolute_time());
+
+        REQUIRE(latency::latency_stats().samples == 1);
+        latency::latency_reset();
+    }
+}
@@ -0,0 +1,109 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include "blit.hpp"
+#include "dma_mock.hpp"
+#include "screen_layers.hpp"
+
+using namespace screen;
+
+static int static_draws, dynamic_draws;
+static ws2812::led_color_t background_color;
+
+// the static layer paints the whole screen, the dynamic layer a single pixel on top
+static void draw_background()
+{
+    static_draws++;
+    for (int y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        for (int x = 0; x < SCREEN_WIDTH; x++)
+        {
+            (*scr_screen)[y][x] = background_color;
+        }
+    }
+}
+
+static void draw_ball()
+{
+    dynamic_draws++;
+    (*scr_screen)[1][2] = ws2812_pack_color(255, 255, 255);
+}
+
+static bool screen_is_background(const scr_frame_buffer_t &fb)
+{
+    for (int y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        for (int x = 0; x < SCREEN_WIDTH; x++)
+        {
+            if ((y != 1 || x != 2) && memcmp(&fb[y][x], &background_color, sizeof(background_color)) != 0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Retained-mode layers", "[screen_layers]")
+{
+    static scr_frame_buffer_t frame_a, frame_b;
+    const ws2812::led_color_t white = ws2812_pack_color(255, 255, 255);
+    const scr_layer_t layers[] = {{draw_background, true}, {draw_ball, false}};
+
+    auto *drawn_screen = scr_screen;
+    dma_mock::mock_dma_reset();
+    blit::blit_init();
+    static_draws = dynamic_draws = 0;
+    background_color = ws2812_pack_color(0, 40, 0);
+    scr_screen = &frame_a;
+    scr_layers_init(layers, 2);
+
+    SECTION("A static layer is rendered once and restored through a blit")
+    {
+        scr_layers_compose();
+        REQUIRE(static_draws == 1);
+        REQUIRE(dynamic_draws == 1);
+        REQUIRE(screen_is_background(frame_a));
+        REQUIRE(memcmp(&frame_a[1][2], &white, sizeof(white)) == 0);
+
+        // the next frame goes to the other buffer, which only the blit of the cache can have filled
+        scr_screen = &frame_b;
+        memset(frame_b, 0x55, sizeof(frame_b));
+        const int transfers = dma_mock::mock_dma_transfers();
+        scr_layers_compose();
+        REQUIRE(static_draws == 1);
+        REQUIRE(dynamic_draws == 2);
+        REQUIRE(dma_mock::mock_dma_transfers() == transfers + 1);
+        REQUIRE(screen_is_background(frame_b));
+        REQUIRE(memcmp(&frame_b[1][2], &white, sizeof(white)) == 0);
+    }
+
+    SECTION("An asynchronous restore is not issued twice")
+    {
+        scr_layers_compose();
+        scr_screen = &frame_b;
+        memset(frame_b, 0x55, sizeof(frame_b));
+        const int transfers = dma_mock::mock_dma_transfers();
+        scr_layers_restore_async();
+        scr_layers_compose();
+        REQUIRE(dma_mock::mock_dma_transfers() == transfers + 1);
+        REQUIRE(static_draws == 1);
+        REQUIRE(screen_is_background(frame_b));
+    }
+
+    SECTION("A dirty static layer is rendered again")
+    {
+        scr_layers_compose();
+        background_color = ws2812_pack_color(0, 0, 90);
+        scr_layers_compose();
+        REQUIRE(static_draws == 1);
+        REQUIRE_FALSE(screen_is_background(frame_a));
+
+        scr_layers_invalidate();
+        scr_layers_compose();
+        REQUIRE(static_draws == 2);
+        REQUIRE(dynamic_draws == 3);
+        REQUIRE(screen_is_background(frame_a));
+    }
+
+    scr_screen = drawn_screen;
+}
@@ -0,0 +1,42 @@
+#include <catch2/catch_test_macros.hpp>
+#include "seqlock.hpp"
+
+using namespace seqlock;
+
+typedef struct
+{
+    uint32_t frames;
+    int64_t stamp;
+} record_t;
+
+TEST_CASE("Seqlock records", "[seqlock]")
+{
+    static seqlock_t<record_t> lock = {};
+    lock.value = {};
+    lock.seq = 0;
+
+    SECTION("Readers get the last complete write")
+    {
+        REQUIRE(seqlock_read(lock).frames == 0);
+        for (int i = 1; i <= 3; i++)
+        {
+            seqlock_write(lock, [&](record_t &record)
+                          {
+                              record.frames++;
+                              record.stamp = 100 * i;
+                          });
+        }
+        const record_t record = seqlock_read(lock);
+        REQUIRE(record.frames == 3);
+        REQUIRE(record.stamp == 300);
+    }
+
+    SECTION("The sequence is odd only while a write is in progress")
+    {
+        bool odd_inside = false;
+        seqlock_write(lock, [&](record_t &)
+                      { odd_inside = lock.seq.load() & 1; });
+        REQUIRE(odd_inside);
+        REQUIRE((lock.seq.load() & 1) == 0);
+    }
+}
@@ -0,0 +1,232 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string.h>
+#include "shard.hpp"
+#include "time_mock.hpp"
+
+using namespace shard;
+using namespace screen;
+
+static scr_frame_buffer_t frame;
+static shard_encoder_t encoder;
+static shard_decoder_t decoder;
+static uint8_t packet[SHARD_MAX_PACKET];
+
+// a pong-like frame: two paddles and a ball that moves every frame
+static void draw_frame(const int t)
+{
+    memset(frame, 0, sizeof(frame));
+    for (int y = 10; y < 18; y++)
+    {
+        frame[y][1] = ws2812_pack_color(0, 0, 255);
+        frame[y][SCREEN_WIDTH - 2] = ws2812_pack_color(255, 0, 0);
+    }
+    frame[(t / 2) % SCREEN_HEIGHT][t % SCREEN_WIDTH] = ws2812_pack_color(255, 255, 255);
+}
+
+// sends one frame over the link and feeds the follower; returns the bytes on the wire
+static size_t send_frame(const shard_link_t &link, const uint8_t seq, shard_event_t &last_event)
+{
+    size_t bytes = shard_encode(encoder, seq, &frame[0][0], SCREEN_WIDTH, packet);
+    link.write(packet, bytes);
+    const size_t present = shard_encode_present(seq, 0, packet);
+    link.write(packet, present);
+    bytes += present;
+
+    last_event = SHARD_EVENT_NONE;
+    uint8_t byte;
+    while (link.read(&byte, 1))
+    {
+        const shard_event_t event = shard_decoder_push(decoder, byte);
+        if (event != SHARD_EVENT_NONE)
+        {
+            last_event = event;
+        }
+    }
+    return bytes;
+}
+
+static bool follower_matches()
+{
+    for (int y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        for (int x = 0; x < SCREEN_WIDTH; x++)
+        {
+            if (decoder.frame[y][x].r != frame[y][x].r || decoder.frame[y][x].g != frame[y][x].g || decoder.frame[y][x].b != frame[y][x].b)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Sharded display link", "[shard]")
+{
+    const shard_link_t link = shard_link_loopback();
+    shard_encoder_init(encoder, 0, {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT});
+    shard_decoder_init(decoder, 0);
+    shard_event_t event;
+
+    SECTION("Frames arrive intact and deltas are small")
+    {
+        draw_frame(0);
+        const size_t key = send_frame(link, 1, event);
+        REQUIRE(key == SHARD_MAX_PACKET + SHARD_PRESENT_PACKET); // a full key frame and the present
+        REQUIRE(event == SHARD_EVENT_PRESENT);
+        REQUIRE(follower_matches());
+
+        for (int t = 1; t < 20; t++)
+        {
+            draw_frame(t);
+            const size_t delta = send_frame(link, 1 + t, event);
+            REQUIRE(event == SHARD_EVENT_PRESENT);
+            REQUIRE(follower_matches());
+            REQUIRE(delta < 40);
+        }
+        REQUIRE(decoder.packets_dropped == 0);
+    }
+
+    SECTION("A corrupted packet holds the follower until the next key frame")
+    {
+        draw_frame(0);
+        send_frame(link, 1, event);
+
+        draw_frame(1);
+        const size_t length = shard_encode(encoder, 2, &frame[0][0], SCREEN_WIDTH, packet);
+        packet[length - 3] ^= 0x40;
+        link.write(packet, length);
+        draw_frame(2);
+        send_frame(link, 3, event);
+        REQUIRE(event == SHARD_EVENT_NONE);
+        REQUIRE(decoder.packets_dropped == 2);
+        REQUIRE_FALSE(decoder.in_sync);
+
+        encoder.frames_since_key = SHARD_KEY_INTERVAL;
+        draw_frame(3);
+        send_frame(link, 4, event);
+        REQUIRE(event == SHARD_EVENT_PRESENT);
+        REQUIRE(follower_matches());
+    }
+
+    SECTION("Followers ignore the shards of others")
+    {
+        shard_decoder_init(decoder, 1);
+        draw_frame(5);
+        send_frame(link, 1, event);
+        REQUIRE(event == SHARD_EVENT_NONE);
+        REQUIRE(decoder.frame[10][1].b == 0);
+    }
+
+    SECTION("The shards of a larger canvas reach their own followers")
+    {
+        // a 2x2 wall: every follower shows a quadrant of a canvas twice the size of its leds
+        static ws2812::led_color_t canvas[2 * PANEL_HEIGHT][2 * PANEL_WIDTH];
+        static shard_encoder_t encoders[4];
+        static shard_decoder_t decoders[4];
+        static uint8_t packets[4 * SHARD_MAX_PACKET + SHARD_PRESENT_PACKET];
+        for (int i = 0; i < 4; i++)
+        {
+            shard_encoder_init(encoders[i], i, {(i % 2) * PANEL_WIDTH, (i / 2) * PANEL_HEIGHT, PANEL_WIDTH, PANEL_HEIGHT});
+            shard_decoder_init(decoders[i], i);
+        }
+        for (int y = 0; y < 2 * PANEL_HEIGHT; y++)
+        {
+            for (int x = 0; x < 2 * PANEL_WIDTH; x++)
+            {
+                canvas[y][x] = ws2812_pack_color(x * 2, y * 3, (x ^ y) & 0xff);
+            }
+        }
+
+        const size_t length = shard_encode_frame(encoders, 4, 1, 0, &canvas[0][0], 2 * PANEL_WIDTH, packets);
+        REQUIRE(length == 4 * SHARD_MAX_PACKET + SHARD_PRESENT_PACKET);
+
+        for (int i = 0; i < 4; i++)
+        {
+            shard_event_t last = SHARD_EVENT_NONE;
+            for (size_t j = 0; j < length; j++)
+            {
+                const shard_event_t pushed = shard_decoder_push(decoders[i], packets[j]);
+                last = pushed != SHARD_EVENT_NONE ? pushed : last;
+            }
+            REQUIRE(last == SHARD_EVENT_PRESENT);
+            REQUIRE(decoders[i].packets_dropped == 0);
+
+            bool matches = true;
+            for (int y = 0; y < PANEL_HEIGHT; y++)
+            {
+                for (int x = 0; x < PANEL_WIDTH; x++)
+                {
+                    const ws2812::led_color_t &c = canvas[(i / 2) * PANEL_HEIGHT + y][(i % 2) * PANEL_WIDTH + x];
+                    const ws2812::led_color_t &d = decoders[i].frame[y][x];
+                    matches = matches && c.r == d.r && c.g == d.g && c.b == d.b;
+                }
+            }
+            REQUIRE(matches);
+        }
+    }
+}
+
+TEST_CASE("Sharded display present deadline", "[shard]")
+{
+    // a master and three followers on one 3 Mbaud wire; the followers poll it every microsecond
+    const uint32_t delay_us = 12000;
+    time_mock::mock_time_set(100000);
+    const shard_link_t link = shard_link_loopback(3333);
+    static ws2812::led_color_t canvas[PANEL_HEIGHT][2 * PANEL_WIDTH];
+    static shard_encoder_t encoders[3];
+    static shard_decoder_t decoders[3];
+    static uint8_t packets[3 * SHARD_MAX_PACKET + SHARD_PRESENT_PACKET];
+    for (int i = 0; i < 3; i++)
+    {
+        shard_encoder_init(encoders[i], i, {(i % 2) * PANEL_WIDTH, 0, PANEL_WIDTH, PANEL_HEIGHT});
+        shard_decoder_init(decoders[i], i);
+    }
+
+    for (uint8_t seq = 1; seq <= 3; seq++)
+    {
+        for (int x = 0; x < 2 * PANEL_WIDTH; x++)
+        {
+            canvas[seq][x] = ws2812_pack_color(seq * 40, x, 255 - x);
+        }
+
+        // the master writes the frame and holds its own part to the deadline
+        const size_t length = shard_encode_frame(encoders, 3, seq, delay_us, &canvas[0][0], 2 * PANEL_WIDTH, packets);
+        const absolute_time_t written = get_absolute_time();
+        link.write(packets, length);
+        const absolute_time_t master_at = shard_present_deadline(link, written, length, delay_us);
+        REQUIRE(link.busy());
+
+        bool presented[3] = {};
+        int presents = 0;
+        while (presents < 3 && absolute_time_diff_us(written, get_absolute_time()) < 100000) // key frames take about 46 ms
+        {
+            time_mock::mock_time_advance(1);
+            uint8_t byte;
+            while (link.read(&byte, 1))
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    if (shard_decoder_push(decoders[i], byte) == SHARD_EVENT_PRESENT)
+                    {
+                        presented[i] = true;
+                        presents++;
+                    }
+                }
+            }
+        }
+        REQUIRE_FALSE(link.busy());
+
+        // every follower shows the same generation at the deadline of the master
+        for (int i = 0; i < 3; i++)
+        {
+            REQUIRE(presented[i]);
+            REQUIRE(decoders[i].seq == seq);
+            REQUIRE(decoders[i].present_at == master_at);
+            REQUIRE(decoders[i].frame[seq][5].r == seq * 40);
+        }
+        REQUIRE(absolute_time_diff_us(get_absolute_time(), master_at) == (int64_t)delay_us);
+
+        // the next frame goes out once every panel has latched this one
+        time_mock::mock_time_set(master_at);
+    }
+}
@@ -0,0 +1,65 @@
+#include <catch2/catch_test_macros.hpp>
+#include "platform_mock.hpp"
+#include "stall.hpp"
+#include "time_mock.hpp"
+
+using namespace stall;
+
+TEST_CASE("Stall accounting", "[stall]")
+{
+    stall_counter_t counter = {};
+    time_mock::mock_time_set(5000);
+    platform_mock::mock_core_set(0);
+
+    SECTION("An entry that does not wait is only counted")
+    {
+        bool entered = false;
+        stall_enter(counter, []
+                    { return true; }, [&]
+                    { entered = true; });
+        REQUIRE_FALSE(entered);
+        REQUIRE(counter.entries[0] == 1);
+        REQUIRE(counter.waits[0] == 0);
+        REQUIRE(counter.total_us[0] == 0);
+    }
+
+    SECTION("Waits are timed per core, with their maximum")
+    {
+        const uint64_t waits[] = {300, 1200, 50};
+        for (const uint64_t wait : waits)
+        {
+            stall_enter(counter, []
+                        { return false; }, [&]
+                        { time_mock::mock_time_advance(wait); });
+        }
+        platform_mock::mock_core_set(1);
+        stall_enter(counter, []
+                    { return false; }, []
+                    { time_mock::mock_time_advance(70); });
+        platform_mock::mock_core_set(0);
+
+        REQUIRE(counter.entries[0] == 3);
+        REQUIRE(counter.waits[0] == 3);
+        REQUIRE(counter.total_us[0] == 1550);
+        REQUIRE(counter.max_us[0] == 1200);
+        REQUIRE(counter.entries[1] == 1);
+        REQUIRE(counter.waits[1] == 1);
+        REQUIRE(counter.total_us[1] == 70);
+        REQUIRE(counter.max_us[1] == 70);
+    }
+
+    SECTION("Work done while waiting is kept apart from the wait")
+    {
+        stall_enter_busy(counter, []
+                         { return false; }, []
+                         {
+                             time_mock::mock_time_advance(900);
+                             return (int64_t)600;
+                         });
+
+        REQUIRE(counter.waits[0] == 1);
+        REQUIRE(counter.total_us[0] == 300);
+        REQUIRE(counter.max_us[0] == 300);
+        REQUIRE(counter.busy_us[0] == 600);
+    }
+}
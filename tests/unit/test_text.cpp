@@ -0,0 +1,98 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstring>
+#include "text.hpp"
+
+using namespace screen;
+
+static scr_frame_buffer_t fb_a, fb_b;
+
+// the packed font decoded the way the original per-pixel renderer did
+static bool reference_pixel(const char ch, const int row, const int column)
+{
+    const uint8_t *font_char = font_3x5_missing_char;
+    int font_char_column = 0;
+    if (ch >= 32 && ch <= 96)
+    {
+        font_char_column = ch - 32;
+        font_char = font_3x5_32_96_optimized[font_char_column / 2];
+    }
+    else if (ch >= 'a' && ch <= 'z')
+    {
+        font_char_column = ch - 'a' + 'A' - 32;
+        font_char = font_3x5_32_96_optimized[font_char_column / 2];
+    }
+    else if (ch >= 123 && ch <= 126)
+    {
+        font_char_column = ch - 122;
+        font_char = font_3x5_122_126_optimized[font_char_column / 2];
+    }
+    const uint8_t line = (font_char_column % 2) ? font_char[row] : (font_char[row] >> 3);
+    return line & (0b100 >> column);
+}
+
+static constexpr text_3x5_t title = text_3x5("PONG");
+static_assert(title.length == 4, "constant strings are measured at compile time");
+static_assert(text_3x5_width(title.length) == 15, "");
+
+TEST_CASE("Glyph text engine", "[text]")
+{
+    const ws2812::led_color_t white = ws2812_pack_color(255, 255, 255);
+
+    memset(fb_a, 0, sizeof(fb_a));
+    memset(fb_b, 0, sizeof(fb_b));
+
+    SECTION("Expanded glyph masks match the packed font")
+    {
+        for (int ch = 0; ch < 128; ch++)
+        {
+            const uint16_t glyph = font_3x5_glyph((char)ch);
+            for (int row = 0; row < 5; row++)
+            {
+                for (int column = 0; column < 3; column++)
+                {
+                    const bool lit = glyph & (1 << (14 - 3 * row - column));
+                    REQUIRE(lit == reference_pixel((char)ch, row, column));
+                }
+            }
+        }
+    }
+
+    SECTION("Numbers are drawn like their decimal strings")
+    {
+        draw_3x5_unsigned(fb_a, 4096, 20, 3, white, FONT_3X5_RIGHT);
+        draw_3x5_text(fb_b, text_3x5("4096"), 20, 3, white, FONT_3X5_RIGHT);
+        REQUIRE(memcmp(fb_a, fb_b, sizeof(fb_a)) == 0);
+
+        draw_3x5_unsigned(fb_a, 0, 30, 10, white, FONT_3X5_CENTER);
+        draw_3x5_text(fb_b, text_3x5("0"), 30, 10, white, FONT_3X5_CENTER);
+        REQUIRE(memcmp(fb_a, fb_b, sizeof(fb_a)) == 0);
+    }
+
+    SECTION("Indexed frame buffers receive palette indices in the same places")
+    {
+        static scr_indexed_frame_buffer_t indexed;
+        memset(indexed, 0, sizeof(indexed));
+
+        draw_3x5_unsigned(fb_a, 1234567890, 2, 20, white);
+        draw_3x5_unsigned(indexed, 1234567890, 2, 20, (uint8_t)7);
+
+        for (int y = 0; y < SCREEN_HEIGHT; y++)
+        {
+            for (int x = 0; x < SCREEN_WIDTH; x++)
+            {
+                REQUIRE((indexed[y][x] == 7) == (fb_a[y][x].r == 255));
+            }
+        }
+    }
+
+    SECTION("Glyphs are clipped at every edge")
+    {
+        // '#' lights all three columns of its second row
+        draw_3x5_glyph(fb_a, font_3x5_glyph('#'), -2, -1, white);
+        draw_3x5_glyph(fb_a, font_3x5_glyph('#'), SCREEN_WIDTH - 1, SCREEN_HEIGHT - 2, white);
+
+        REQUIRE(fb_a[0][0].r == 255);
+        REQUIRE(fb_a[SCREEN_HEIGHT - 1][SCREEN_WIDTH - 1].r == 255);
+        REQUIRE(fb_a[0][1].r == 0);
+    }
+}
@@ -0,0 +1,118 @@
+#include <catch2/catch_test_macros.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "platform_mock.hpp"
+#include "time_mock.hpp"
+#include "trace.hpp"
+
+using namespace trace;
+
+static std::string captured(void (*write)(FILE *))
+{
+    char *text = nullptr;
+    size_t size = 0;
+    FILE *f = open_memstream(&text, &size);
+    write(f);
+    fclose(f);
+    std::string s(text, size);
+    free(text);
+    return s;
+}
+
+static trace_record_t __records[TRACE_EVENTS];
+static uint32_t __count;
+
+static void write_json(FILE *f)
+{
+    trace_write_json(f, __records, __count);
+}
+
+TEST_CASE("Event trace", "[trace]")
+{
+    trace_clear();
+    time_mock::mock_time_set(1000);
+
+    SECTION("Records keep their time, core, phase and name")
+    {
+        trace_begin(TRACE_GAME_UPDATE);
+        time_mock::mock_time_advance(250);
+        trace_end(TRACE_GAME_UPDATE);
+        platform_mock::mock_core_set(1);
+        trace_instant(TRACE_DMA_DONE);
+        platform_mock::mock_core_set(0);
+
+        REQUIRE(trace_snapshot(__records, TRACE_EVENTS) == 3);
+        REQUIRE(__records[0].name == TRACE_GAME_UPDATE);
+        REQUIRE(__records[0].phase == TRACE_BEGIN);
+        REQUIRE(__records[0].time_us == 1000);
+        REQUIRE(__records[1].phase == TRACE_END);
+        REQUIRE(__records[1].time_us == 1250);
+        REQUIRE(__records[2].phase == TRACE_INSTANT);
+        REQUIRE(__records[2].core == 1);
+    }
+
+    SECTION("The ring keeps the latest records, oldest first")
+    {
+        for (uint32_t i = 0; i < TRACE_EVENTS + 10; i++)
+        {
+            time_mock::mock_time_set(i);
+            trace_instant(TRACE_LATCHED);
+        }
+        REQUIRE(trace_snapshot(__records, TRACE_EVENTS) == TRACE_EVENTS);
+        REQUIRE(__records[0].time_us == 10);
+        REQUIRE(__records[TRACE_EVENTS - 1].time_us == TRACE_EVENTS + 9);
+
+        REQUIRE(trace_snapshot(__records, 4) == 4);
+        REQUIRE(__records[0].time_us == TRACE_EVENTS + 6);
+    }
+
+    SECTION("Dumped lines parse back to the same records")
+    {
+        trace_begin(TRACE_SUBMIT);
+        platform_mock::mock_core_set(1);
+        trace_end(TRACE_SUBMIT);
+        platform_mock::mock_core_set(0);
+
+        const std::string dump = captured(trace_dump);
+        REQUIRE(dump == "trace 1000 0 B submit\ntrace 1000 1 E submit\n");
+
+        trace_record_t record;
+        REQUIRE(trace_parse_line("trace 1000 1 E submit\n", record));
+        REQUIRE(record.time_us == 1000);
+        REQUIRE(record.core == 1);
+        REQUIRE(record.phase == TRACE_END);
+        REQUIRE(record.name == TRACE_SUBMIT);
+
+        REQUIRE_FALSE(trace_parse_line("FPS 60; rasterise: 000010 us;\n", record));
+        REQUIRE_FALSE(trace_parse_line("trace 1000 1 E no_such_event\n", record));
+        REQUIRE_FALSE(trace_parse_line("trace 1000 1 X submit\n", record));
+    }
+
+    SECTION("Chrome trace json, with the 32-bit clock unwrapped")
+    {
+        __count = 0;
+        REQUIRE(trace_parse_line("trace 4294967000 0 B game_draw", __records[__count++]));
+        REQUIRE(trace_parse_line("trace 4294966990 1 i dma_done", __records[__count++])); // stamped just before
+        REQUIRE(trace_parse_line("trace 200 0 E game_draw", __records[__count++]));
+
+        const std::string json = captured(write_json);
+        REQUIRE(json.find("\"traceEvents\":[") != std::string::npos);
+        REQUIRE(json.find("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"core1\"}}") != std::string::npos);
+        REQUIRE(json.find("{\"name\":\"game_draw\",\"ph\":\"B\",\"ts\":4294967000,\"pid\":0,\"tid\":0}") != std::string::npos);
+        REQUIRE(json.find("{\"name\":\"dma_done\",\"ph\":\"i\",\"ts\":4294966990,\"pid\":0,\"tid\":1,\"s\":\"t\"}") != std::string::npos);
+        REQUIRE(json.find("{\"name\":\"game_draw\",\"ph\":\"E\",\"ts\":4294967496,\"pid\":0,\"tid\":0}") != std::string::npos);
+        REQUIRE(json.substr(json.size() - 4) == "\n]}\n");
+    }
+
+    SECTION("Every name has its text")
+    {
+        for (int i = 0; i < TRACE_NAMES; i++)
+        {
+            trace_name_t name;
+            REQUIRE(trace_name_find(trace_name((trace_name_t)i), name));
+            REQUIRE(name == i);
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#include <stdio.h>
+#include <vector>
+
+#include "trace.hpp"
+
+// host converter: reads the serial log of a board that called trace::trace_dump(), keeps the trace lines
+// and writes them as chrome trace event json
+// usage: trace_to_json [log [json]]; stdin and stdout by default
+int main(int argc, char **argv)
+{
+    FILE *in = argc > 1 ? fopen(argv[1], "r") : stdin;
+    FILE *out = argc > 2 ? fopen(argv[2], "w") : stdout;
+    if (!in || !out)
+    {
+        fprintf(stderr, "trace_to_json: cannot open %s\n", !in ? argv[1] : argv[2]);
+        return 1;
+    }
+
+    std::vector<trace::trace_record_t> records;
+    char line[256];
+    while (fgets(line, sizeof(line), in))
+    {
+        trace::trace_record_t record;
+        if (trace::trace_parse_line(line, record))
+        {
+            records.push_back(record);
+        }
+    }
+    trace::trace_write_json(out, records.data(), records.size());
+
+    fprintf(stderr, "trace_to_json: %zu events\n", records.size());
+    return 0;
+}